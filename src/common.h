@@ -48,4 +48,71 @@
 #define ADRM_IMM  false
 #define ADRM_REG  true
 
+/* REGISTER MODE OF LDM, STR & CAS: MIII IIII   RRRR XXXX   OOOO OOOO
+ * - ADDRESS = BASE + O (8BITS OFFSET), BASE IS THE REGISTER OR, WITH INDEX_PAIR, THE 12BITS PAIR
+ *   R0:R1 (FOR R0 & R1) OR R2:R3 (FOR R2 & R3), THE LOW NIBBLE OF THE 1ST REGISTER IS THE HIGH PART
+ * - WITH INDEX_INC THE BASE IS INCREMENTED AFTER THE ACCESS
+ * - XXXX = 0 & O = 0 IS THE ORIGINAL RAM[REG]
+ */
+#define INDEX_PAIR  0x1
+#define INDEX_INC   0x2
+
+/* BLOCK INSTRUCTIONS (BMOV & FILL), EXECUTED WITH THE HOST memmove & memset:
+ * - IMMEDIATE MODE: MIII IIII   xxxx AAAA   AAAA AAAA, A IS THE ADDRESS OF A BLOCK_DESC BYTES DESCRIPTOR
+ *   DST, SRC, LEN (16BITS EACH, HIGH BYTE FIRST), FILL STORE THE LOW BYTE OF SRC; AT MOST BLOCK_CHUNK
+ *   BYTES ARE DONE PER EXECUTION, THE DESCRIPTOR IS UPDATED TO WHAT IS LEFT & THE INSTRUCTION IS
+ *   EXECUTED AGAIN UNTIL LEN = 0, SO AN INTERRUPT IS SERVED BETWEEN TWO CHUNKS
+ * - REGISTER MODE: MIII IIII   DDSS xxxx   CCCC CCCC, DST IS THE PAIR OF D (R0:R1 OR R2:R3), SRC THE PAIR
+ *   OF S (BMOV) OR THE VALUE IN S (FILL), C BYTES (0 = 256) IN ONE EXECUTION; THE PAIRS ARE ADVANCED PAST
+ *   THE BLOCK
+ * - THE ADDRESSES WRAP AT 12BITS, EACH BYTE COST ONE MORE CYCLE, THE FLAGS ARE NOT CHANGED
+ */
+#define BLOCK_DESC   6
+#define BLOCK_CHUNK  64
+
+/* OPCODES, SHARED BY THE EMULATOR & THE TOOLS */
+typedef enum inst
+{
+    HLT  = 0x00,
+    LDR  = 0x01,
+    LDM  = 0x02,
+    STI  = 0x03,
+    STR  = 0x04,
+    ADD  = 0x05,
+    SUB  = 0x06,
+    CMP  = 0x07,
+    JZ   = 0x08, /* JUMP IF ZERO; SAME AS JE "x == y" */
+    JN   = 0x09, /* JUMP IF NEGATIVE */
+    JC   = 0x0A, /* JUMP IF CARRY; SAME AS JB (JUMP IF BELOW) "x < y" */
+    JNC  = 0x0B, /* JUMP IF NOT CARRY; SAME AS JAE (JUMP IF ABOVE OR EQUAL) " x >= y" */
+    JBE  = 0x0C, /* JUMP IF BELOW OR EQUAL (CARRY OR ZERO) "x <= y */
+    JA   = 0x0D, /* JUMP IF ABOVE (!CARRY AND !ZERO) "x > y" */
+    JMP  = 0x0E,
+    JNZ  = 0x0F, /* JUMP IF NOT ZERO; SAME AS JNE "x != y" */
+    JNN  = 0x10, /* JUMP IF NOT NEGATIVE */
+    PUSH = 0x11,
+    POP  = 0x12,
+    CALL = 0x13,
+    RET  = 0x14,
+    IN   = 0x15,
+    OUT  = 0x16,
+    SYS  = 0x17,
+    SEI  = 0x18,
+    SDI  = 0x19,
+    CAS  = 0x1A, /* ATOMIC COMPARE R0 WITH MEMORY & EXCHANGE WITH REG IF EQUAL (Z = SUCCESS) */
+    AND  = 0x1B,
+    OR   = 0x1C,
+    XOR  = 0x1D,
+    NOT  = 0x1E,
+    SHL  = 0x1F, /* SHIFT LEFT BY 0-7 BITS, C IF A 1 IS SHIFTED OUT (LIKE ADD) */
+    SHR  = 0x20, /* LOGICAL SHIFT RIGHT BY 0-7 BITS, C IS THE LAST BIT SHIFTED OUT */
+    ROL  = 0x21, /* ROTATE LEFT BY 0-7 BITS */
+    ROR  = 0x22, /* ROTATE RIGHT BY 0-7 BITS */
+    INC  = 0x23,
+    DEC  = 0x24,
+    DJNZ = 0x25, /* DECREMENT REG & JUMP IF NOT ZERO, FLAGS UNCHANGED */
+    BMOV = 0x26, /* BLOCK MOVE (memmove) */
+    FILL = 0x27, /* BLOCK FILL (memset) */
+} inst_t;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,164 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include "clock.h"
+#include "event.h"
+
+
+typedef struct FemtoClock
+{
+    uint64_t  freq;        /* GUEST CYCLES PER SECOND */
+    uint64_t  slice;       /* GUEST CYCLES PER SLICE */
+    uint64_t  base;        /* GUEST CYCLE OF THE HOST TIME start */
+    uint64_t  start;       /* HOST TIME (ns) */
+    uint64_t  slices;
+    uint64_t  late;        /* SLICES ENDED AFTER THEIR DEADLINE, NO SLEEP */
+    uint64_t  resyncs;
+    uint64_t  jitter_sum;  /* WAKE-UP DELAY AFTER THE DEADLINE (ns) */
+    uint64_t  jitter_max;
+    uint64_t  slept;       /* HOST TIME SLEPT (ns) */
+} FemtoClock_t;
+
+
+/* THE END OF A SLICE IS SCHEDULED ON THE EVENTS OF ONE MACHINE */
+static FemtoClock_t Clock;
+
+
+/*** HELPING FUNCTIONS ***/
+static uint64_t ClockNow(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/* HOST TIME OF A GUEST CYCLE, WITHOUT OVERFLOW OF cycles * 1e9 */
+static uint64_t ClockDeadline(uint64_t cycles)
+{
+    uint64_t elapsed = cycles - Clock.base;
+
+    return Clock.start + ((elapsed / Clock.freq) * 1000000000ULL) + (((elapsed % Clock.freq) * 1000000000ULL) / Clock.freq);
+}
+
+static void ClockSlice(FemtoEmu_t *emu, void *arg)
+{
+    uint64_t deadline = ClockDeadline(emu->cycles);
+    uint64_t now      = ClockNow();
+
+    (void)arg;
+    Clock.slices++;
+
+    if (now < deadline)
+    {
+        struct timespec ts  = { (time_t)(deadline / 1000000000ULL), (long)(deadline % 1000000000ULL) };
+        int             err = 0;
+
+        /* THE SLEEP IS ABSOLUTE, A SIGNAL (EINTR) JUST RESUME IT; ANY OTHER ERROR WOULD NEVER END */
+        while ((err = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL)) == EINTR);
+        if (err != 0)
+        {
+            printf("ERROR (ClockSlice): CAN'T SLEEP UNTIL THE DEADLINE (%s) !!!\n", strerror(err));
+            exit(-1);
+        }
+        Clock.slept += deadline - now;
+        now          = ClockNow();
+
+        Clock.jitter_sum += now - deadline;
+        if (now - deadline > Clock.jitter_max) Clock.jitter_max = now - deadline;
+    }
+    else if (now - deadline > CLOCK_MAX_LAG_NS)
+    {
+        /* TOO LATE TO CATCH UP, THE GUEST TIME RESTART FROM NOW */
+        Clock.base  = emu->cycles;
+        Clock.start = now;
+        Clock.resyncs++;
+    }
+    else
+    {
+        Clock.late++;
+    }
+
+    EventAdd(emu, emu->cycles + Clock.slice, ClockSlice, NULL);
+}
+/*** END OF HELPING FUNCTIONS ***/
+
+
+/* FREQUENCY IN Hz, WITH AN OPTIONAL k OR M SUFFIX (EX: 1M, 4.77M, 500k), 0 IF INVALID */
+uint64_t ClockParseFreq(const char *freq)
+{
+    char   *end = NULL;
+    double  hz  = strtod(freq, &end);
+
+    if (end == freq) return 0;
+    if (*end == 'k' || *end == 'K') hz *= 1e3;
+    if (*end == 'm' || *end == 'M') hz *= 1e6;
+
+    return (hz < 1.0) ? 0 : (uint64_t)hz;
+}
+
+
+/* MUST BE CALLED JUST BEFORE EmuLoop, THE HOST TIME START NOW */
+void ClockInit(FemtoEmu_t *emu, uint64_t freq, bool verbose)
+{
+    if (freq == 0)
+    {
+        printf("ERROR (ClockInit): INVALID GUEST CLOCK FREQUENCY !!!\n");
+        exit(-1);
+    }
+
+    Clock       = (FemtoClock_t){0};
+    Clock.freq  = freq;
+    Clock.slice = (freq * CLOCK_SLICE_NS) / 1000000000ULL;
+    if (Clock.slice == 0) Clock.slice = 1;
+    Clock.base  = emu->cycles;
+    Clock.start = ClockNow();
+
+    EventAdd(emu, emu->cycles + Clock.slice, ClockSlice, NULL);
+    if (verbose == true) printf("CLOCK: %llu Hz, %llu CYCLES PER SLICE\n", (unsigned long long)freq, (unsigned long long)Clock.slice);
+}
+
+
+void ClockReport(const FemtoEmu_t *emu)
+{
+    uint64_t host  = ClockNow() - Clock.start;
+    uint64_t guest = ClockDeadline(emu->cycles) - Clock.start;
+    uint64_t slept = (Clock.slices > Clock.late + Clock.resyncs) ? Clock.slices - Clock.late - Clock.resyncs : 0;
+
+    printf("CLOCK: %llu Hz, %llu SLICES (%llu LATE, %llu RESYNC), JITTER AVG %llu ns MAX %llu ns\n",
+           (unsigned long long)Clock.freq, (unsigned long long)Clock.slices, (unsigned long long)Clock.late,
+           (unsigned long long)Clock.resyncs, (unsigned long long)((slept > 0) ? Clock.jitter_sum / slept : 0),
+           (unsigned long long)Clock.jitter_max);
+    printf("CLOCK: DRIFT %+.3f ms (HOST %.3f s, GUEST %.3f s), HOST SLEPT %.1f%%\n",
+           ((double)host - (double)guest) / 1e6, (double)host / 1e9, (double)guest / 1e9,
+           (host > 0) ? (100.0 * (double)Clock.slept) / (double)host : 0.0);
+}
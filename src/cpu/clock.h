@@ -0,0 +1,52 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+/* REAL-TIME PACING:
+ * - THE GUEST RUN AT freq CYCLES PER SECOND, IN SLICES OF CLOCK_SLICE_NS OF GUEST TIME
+ * - THE END OF A SLICE IS AN EVENT (event.h): THE HOST THREAD SLEEP UNTIL THE ABSOLUTE HOST TIME
+ *   OF THIS CYCLE (clock_nanosleep, CLOCK_MONOTONIC), SO THE ERRORS OF THE SLICES NEVER ADD UP
+ * - A HOST LATE OF MORE THAN CLOCK_MAX_LAG_NS (SUSPENDED, OVERLOADED) RESYNC THE CLOCK INSTEAD OF
+ *   RUNNING FLAT OUT TO CATCH UP
+ * - WITH --idle, A POLLING LOOP IS FAST-FORWARDED TO THE END OF THE SLICE, THE HOST SLEEP THE REST
+ */
+
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../femto.h"
+
+#define CLOCK_SLICE_NS    1000000     /* 1ms */
+#define CLOCK_MAX_LAG_NS  100000000   /* 100ms */
+
+
+uint64_t ClockParseFreq(const char *freq);
+void     ClockInit(FemtoEmu_t *emu, uint64_t freq, bool verbose);
+void     ClockReport(const FemtoEmu_t *emu);
+
+#endif
@@ -26,6 +26,7 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 #include "cpu.h"
 #include "int.h"
 #include "../common.h"
@@ -61,20 +62,170 @@ uint8_t UpdateFlags(int testing)
     return temp_flags;
 }
 
+/* N, C & Z OF THE ALU INSTRUCTIONS FROM THEIR RESULT, THE I FLAG IS KEPT (femto.h) */
+static inline void SetFlagsKeepI(FemtoEmu_t *emu, int result)
+{
+    FLAGS = (FLAGS & 0x8) | UpdateFlags(result);
+}
+
+/* SOURCE OPERAND OF THE ALU INSTRUCTIONS: REG | IMM */
+static inline uint8_t SrcOperand(FemtoEmu_t *emu)
+{
+    return (ADRM == ADRM_IMM) ? DATA : R[SREG];
+}
+
+/* POST-INCREMENT OF THE BASE OF LDM, STR & CAS IN REGISTER MODE (INDEX_INC), A PAIR WRAP AT 12BITS */
+static inline void IndexIncrement(FemtoEmu_t *emu, uint8_t reg)
+{
+    uint8_t mode = (ADDR >> 8) & 0x0F;
+
+    if (!(mode & INDEX_INC)) return;
+    if (mode & INDEX_PAIR)
+    {
+        PairSet(emu, reg, (uint16_t)(PairGet(emu, reg) + 1));
+    }
+    else
+    {
+        R[reg]++;
+    }
+}
+
+/* BMOV & FILL ON A SHARED RAM: BYTE BY BYTE WITH RAM_LOAD & RAM_STORE, IN THE memmove ORDER; value < 0 : MOVE */
+static void BlockShared(FemtoEmu_t *emu, uint16_t d, uint16_t s, uint16_t n, int value)
+{
+    if (value >= 0)
+    {
+        for (uint16_t i = 0; i < n; i++) RAM_STORE(d + i, value);
+    }
+    else if (d > s)
+    {
+        for (uint16_t i = n; i > 0; i--) RAM_STORE(d + i - 1, RAM_LOAD(s + i - 1));
+    }
+    else
+    {
+        for (uint16_t i = 0; i < n; i++) RAM_STORE(d + i, RAM_LOAD(s + i));
+    }
+}
+
+/* MOVE (OR FILL WITH THE LOW BYTE OF src) AT MOST max OF THE len BYTES, PIECES NEVER CROSS THE END OF THE RAM;
+ * dst, src & len ARE UPDATED TO WHAT IS LEFT, RETURN THE BYTES DONE */
+static uint16_t BlockRun(FemtoEmu_t *emu, uint16_t *dst, uint16_t *src, uint16_t *len, bool fill, uint16_t max)
+{
+    /* A FORWARD OVERLAP IS MOVED FROM ITS END, SO THE SOURCE IS READ BEFORE IT IS OVERWRITTEN */
+    bool     tail = !fill && *dst != *src && ((*dst - *src) & 0xFFF) < *len;
+    uint16_t done = 0;
+
+    while (*len > 0 && done < max)
+    {
+        uint16_t n = (*len < max - done) ? *len : (uint16_t)(max - done);
+        uint16_t d = *dst;
+        uint16_t s = *src;
+
+        if (tail)
+        {
+            /* END OF THE BLOCKS, 0x001 - 0x1000 */
+            uint16_t dend = ((*dst + *len - 1) & 0xFFF) + 1;
+            uint16_t send = ((*src + *len - 1) & 0xFFF) + 1;
+
+            if (n > dend) n = dend;
+            if (n > send) n = send;
+            d = dend - n;
+            s = send - n;
+        }
+        else
+        {
+            if (n > 0x1000 - d)          n = 0x1000 - d;
+            if (!fill && n > 0x1000 - s) n = 0x1000 - s;
+            *dst = (d + n) & 0xFFF;
+            if (!fill) *src = (s + n) & 0xFFF;
+        }
+
+        for (uint16_t page = d & 0xF00; page < d + n; page += PAGE_SIZE) MARK_DIRTY(page)
+        if (emu->shared)      BlockShared(emu, d, s, n, fill ? (int)(uint8_t)*src : -1);
+        else if (fill)        memset(RAM + d, (uint8_t)*src, n);
+        else                  memmove(RAM + d, RAM + s, n);
+        *len -= n;
+        done += n;
+    }
+
+    return done;
+}
+
+/* BMOV & FILL, SEE common.h */
+static void BlockExec(FemtoEmu_t *emu, bool verbose, bool fill)
+{
+    const char *name = fill ? "FILL" : "BMOV";
+    uint16_t    len  = 0;
+    uint16_t    dst  = BlockDest(emu, ADRM, DREG, ADDR, &len);
+    uint16_t    src  = 0;
+    uint16_t    done = 0;
+
+    if (ADRM == ADRM_IMM)
+    {
+        src  = (uint16_t)(((RAM_LOAD((ADDR + 2) & 0xFFF) & (fill ? 0x00 : 0x0F)) << 8) | RAM_LOAD((ADDR + 3) & 0xFFF));
+        done = BlockRun(emu, &dst, &src, &len, fill, BLOCK_CHUNK);
+
+        /* THE DESCRIPTOR HOLD WHAT IS LEFT */
+        for (int i = 0; i < BLOCK_DESC; i++) MARK_DIRTY((ADDR + i) & 0xFFF)
+        RAM_STORE(ADDR & 0xFFF, dst >> 8);
+        RAM_STORE((ADDR + 1) & 0xFFF, dst);
+        if (!fill)
+        {
+            RAM_STORE((ADDR + 2) & 0xFFF, src >> 8);
+            RAM_STORE((ADDR + 3) & 0xFFF, src);
+        }
+        RAM_STORE((ADDR + 4) & 0xFFF, len >> 8);
+        RAM_STORE((ADDR + 5) & 0xFFF, len);
+
+        /* NOT DONE, EXECUTED AGAIN AFTER THE INTERRUPTS, IF ANY */
+        if (len > 0) PC -= 3;
+        if (verbose == true) printf("%s: DESCRIPTOR 0x%03X, %d BYTES DONE, %d LEFT\n", name, ADDR, done, len);
+    }
+    else
+    {
+        uint16_t to   = dst;
+        uint16_t from = 0;
+
+        src  = fill ? R[SREG] : PairGet(emu, SREG);
+        from = src;
+        done = BlockRun(emu, &dst, &src, &len, fill, 0x100);
+
+        if (!fill) PairSet(emu, SREG, (uint16_t)(from + done));
+        PairSet(emu, DREG, (uint16_t)(to + done));
+        if (verbose == true) printf("%s: RAM[R%d PAIR (0x%03X)], %d BYTES FROM %s R%d (0x%03X)\n", name, DREG & 0x2, to, done, fill ? "VALUE" : "PAIR", fill ? SREG : SREG & 0x2, from);
+    }
+
+    CYCLES += done;
+}
+
 void PrintFlags(FemtoEmu_t *emu, bool verbose)
 {
     if (verbose == true) printf("FLAGS: I : %01X; N : %01X; C : %01X; Z : %01X\n", IFLAG, NFLAG, CFLAG, ZFLAG);
 }
 
+/* EDGE COVERAGE: HIT COUNT OF (PREVIOUS BLOCK, NEW BLOCK) PAIRS, CALLED AFTER EVERY CONTROL TRANSFER */
+void CovEdge(FemtoEmu_t *emu)
+{
+    uint16_t cur  = (uint16_t)(((uint32_t)(PC & 0xFFF) * 0x9E3779B1u) >> 16);
+    uint16_t edge = (cur ^ emu->cov_prev) & (COV_SIZE - 1);
+
+    emu->cov[edge]++;
+    emu->cov_prev = cur >> 1;
+    if (emu->cov_lines != NULL) emu->cov_lines[edge >> 12] |= 1ull << ((edge >> 6) & 63);
+}
+
 /* STACK HELPING FUNCTIONS */
 void StackPushByte(FemtoEmu_t *emu, uint8_t byte)
 {
-    RAM[STACK_BASE + (SP++)] = byte;
+    if (SP == 0xFF) RAISE_FAULT(FAULT_STACK)
+    MARK_DIRTY(STACK + SP)
+    RAM_STORE(STACK + (SP++), byte);
 }
 
 uint8_t StackPopByte(FemtoEmu_t *emu)
 {
-    return RAM[STACK_BASE + (--SP)];
+    if (SP == 0x00) RAISE_FAULT(FAULT_STACK)
+    return RAM_LOAD(STACK + (--SP));
 }
 /*** END OF HELPING FUNCTIONS ***/
 
@@ -84,7 +235,9 @@ uint8_t StackPopByte(FemtoEmu_t *emu)
 void OpcodeError(FemtoEmu_t *emu, bool verbose)
 {
     if (verbose == true) printf("FATAL ERROR !!! ==> Invalid Opcode 0x%02X at 0x%03X!\n", INST, (PC - 3) % 0xFFF);
-    printf("FATAL ERROR !!! ==> Invalid Opcode 0x%02X at 0x%03X!\n", INST, (PC - 3) % 0xFFF);
+    /* A FUZZED MACHINE (COVERAGE ON) REPORT ITS FAULTS THROUGH emu->fault ONLY */
+    if (emu->cov == NULL) printf("FATAL ERROR !!! ==> Invalid Opcode 0x%02X at 0x%03X!\n", INST, (PC - 3) % 0xFFF);
+    RAISE_FAULT(FAULT_OPCODE)
     HALT = true;
     return;
 }
@@ -116,13 +269,16 @@ void OpcodeLdm(FemtoEmu_t *emu, bool verbose)
     /* LDM DREG, SREG | IMM */
     if (ADRM == ADRM_IMM)
     {
-        R[DREG] = RAM[ADDR];
+        R[DREG] = RAM_LOAD(ADDR);
         if (verbose == true) printf("LDM: R%d = 0x%02X (RAM[0x%03X])\n", DREG, R[DREG], ADDR);
     }
     else if (ADRM == ADRM_REG)
     {
-        R[DREG] = RAM[R[SREG]];
-        if (verbose == true) printf("LDM: R%d = 0x%02X (RAM[R%d] (0x%02X))\n", DREG, R[DREG], SREG, R[SREG]);
+        uint16_t address = IndexAddress(emu, SREG, ADDR);
+
+        R[DREG] = RAM_LOAD(address);
+        if (verbose == true) printf("LDM: R%d = 0x%02X (RAM[R%d%s + 0x%02X] (0x%03X))\n", DREG, R[DREG], SREG, ((ADDR >> 8) & INDEX_PAIR) ? " PAIR" : "", DATA, address);
+        IndexIncrement(emu, SREG);
     }
 }
                 
@@ -131,12 +287,14 @@ void OpcodeSti(FemtoEmu_t *emu, bool verbose)
     /* STI REG, IMM */
     if (ADRM == ADRM_IMM)
     {
-        RAM[R[DREG]] = DATA;
+        MARK_DIRTY(R[DREG])
+        RAM_STORE(R[DREG], DATA);
         if (verbose == true) printf("STI: RAM[R%d (0x%02X)] = 0x%02X\n", DREG, R[DREG], RAM[R[DREG]]);
     }
     else
     {
         printf("ILLEGAL ADDRESSING MODES (REGISTER) FOR STI AT 0x%03X\n", (PC - 3) % 0xFFF);
+        RAISE_FAULT(FAULT_ADRM)
         HALT = true;
     }
 }
@@ -146,44 +304,55 @@ void OpcodeStr(FemtoEmu_t *emu, bool verbose)
     /* STR IMM | REG, REG */
     if (ADRM == ADRM_IMM)
     {
-        RAM[ADDR] = R[SREG];
+        MARK_DIRTY(ADDR)
+        RAM_STORE(ADDR, R[SREG]);
         if (verbose == true) printf("STR: RAM[0x%03X] = 0x%02X (R%d (0x%02X))\n", ADDR, RAM[ADDR], SREG, R[SREG]);
     }
     else if (ADRM == ADRM_REG)
     {
-        RAM[R[DREG]] = R[SREG];
-        if (verbose == true) printf("STR: RAM[R%d (0x%02X)] = 0x%02X (R%d (0x%02X))\n", DREG, R[DREG], RAM[R[DREG]], SREG, R[SREG]);
+        uint16_t address = IndexAddress(emu, DREG, ADDR);
+
+        MARK_DIRTY(address)
+        RAM_STORE(address, R[SREG]);
+        if (verbose == true) printf("STR: RAM[R%d%s + 0x%02X (0x%03X)] = 0x%02X (R%d (0x%02X))\n", DREG, ((ADDR >> 8) & INDEX_PAIR) ? " PAIR" : "", DATA, address, RAM[address], SREG, R[SREG]);
+        IndexIncrement(emu, DREG);
     }
 }
                 
 void OpcodeAdd(FemtoEmu_t *emu, bool verbose)
 {
-    /* ADD REG, REG */
-    TEMP = (int)R[DREG] + (int)R[SREG];
-    FLAGS = UpdateFlags(TEMP);
+    /* ADD REG, REG | IMM */
+    uint8_t src = SrcOperand(emu);
+
+    TEMP = (int)R[DREG] + (int)src;
+    SetFlagsKeepI(emu, TEMP);
     TEMP = R[DREG];
-    R[DREG] += R[SREG];
-    if (verbose == true) printf("ADD: R%d (0x%02X) = R%d (0x%02X) + R%d (0x%02X)\n", DREG, R[DREG], DREG, R[DREG] - R[SREG], SREG, R[SREG]);
+    R[DREG] += src;
+    if (verbose == true) printf("ADD: R%d (0x%02X) = R%d (0x%02X) + 0x%02X\n", DREG, R[DREG], DREG, TEMP, src);
     PrintFlags(emu, verbose);
 }
                 
 void OpcodeSub(FemtoEmu_t *emu, bool verbose)
 {
-    /* SUB REG, REG */
-    TEMP = (int)R[DREG] - (int)R[SREG];
-    FLAGS = UpdateFlags(TEMP);
+    /* SUB REG, REG | IMM */
+    uint8_t src = SrcOperand(emu);
+
+    TEMP = (int)R[DREG] - (int)src;
+    SetFlagsKeepI(emu, TEMP);
     TEMP = R[DREG];
-    R[DREG] -= R[SREG];
-    if (verbose == true) printf("SUB: R%d (0x%02X) = R%d (0x%02X) - R%d (0x%02X)\n", DREG, R[DREG], DREG, TEMP, SREG, R[SREG]);
+    R[DREG] -= src;
+    if (verbose == true) printf("SUB: R%d (0x%02X) = R%d (0x%02X) - 0x%02X\n", DREG, R[DREG], DREG, TEMP, src);
     PrintFlags(emu, verbose);
 }
                 
 void OpcodeCmp(FemtoEmu_t *emu, bool verbose)
 {
-    /* CMP REG, REG */
-    TEMP = R[DREG] - R[SREG];
-    FLAGS = UpdateFlags(TEMP);
-    if (verbose == true) printf("CMP: R%d (0x%02X), R%d (0x%02X)\n", DREG, R[DREG], SREG, R[SREG]);
+    /* CMP REG, REG | IMM */
+    uint8_t src = SrcOperand(emu);
+
+    TEMP = R[DREG] - src;
+    SetFlagsKeepI(emu, TEMP);
+    if (verbose == true) printf("CMP: R%d (0x%02X), 0x%02X\n", DREG, R[DREG], src);
     PrintFlags(emu, verbose);
 }
                 
@@ -192,6 +361,7 @@ void OpcodeJmp(FemtoEmu_t *emu, bool verbose)
     /* JMP IMM */
     PC = ADDR;
     if (verbose == true) printf("JMP TO 0x%03X (PC = 0x%03X)\n", ADDR, PC);
+    COVERAGE(emu)
 }
                 
 void OpcodeJz(FemtoEmu_t *emu, bool verbose)
@@ -206,6 +376,7 @@ void OpcodeJz(FemtoEmu_t *emu, bool verbose)
     {
         if (verbose == true) printf("JZ/JE NOT TAKEN TO 0x%03X (PC = 0x%03X)\n", ADDR, PC);
     }
+    COVERAGE(emu)
 }
 
 void OpcodeJnz(FemtoEmu_t *emu, bool verbose)
@@ -220,6 +391,7 @@ void OpcodeJnz(FemtoEmu_t *emu, bool verbose)
     {
         if (verbose == true) printf("JNZ/JNE NOT TAKEN TO 0x%03X (PC = 0x%03X)\n", ADDR, PC);
     }
+    COVERAGE(emu)
 }
                 
 void OpcodeJn(FemtoEmu_t *emu, bool verbose)
@@ -234,6 +406,7 @@ void OpcodeJn(FemtoEmu_t *emu, bool verbose)
     {
         if (verbose == true) printf("JN NOT TAKEN TO 0x%03X (PC = 0x%03X)\n", ADDR, PC);
     }
+    COVERAGE(emu)
 }
 
 void OpcodeJnn(FemtoEmu_t *emu, bool verbose)
@@ -248,6 +421,7 @@ void OpcodeJnn(FemtoEmu_t *emu, bool verbose)
     {
         if (verbose == true) printf("JNN NOT TAKEN TO 0x%03X (PC = 0x%03X)\n", ADDR, PC);
     }
+    COVERAGE(emu)
 }
                 
 void OpcodeJc(FemtoEmu_t *emu, bool verbose)
@@ -262,6 +436,7 @@ void OpcodeJc(FemtoEmu_t *emu, bool verbose)
     {
         if (verbose == true) printf("JC NOT TAKEN TO 0x%03X (PC = 0x%03X)\n", ADDR, PC);
     }
+    COVERAGE(emu)
 }
                 
 void OpcodeJnc(FemtoEmu_t *emu, bool verbose)
@@ -276,6 +451,7 @@ void OpcodeJnc(FemtoEmu_t *emu, bool verbose)
     {
         if (verbose == true) printf("JNCNOT TAKEN TO 0x%03X (PC = 0x%03X)\n", ADDR, PC);
     }
+    COVERAGE(emu)
 }
 
 void OpcodeJbe(FemtoEmu_t *emu, bool verbose)
@@ -290,6 +466,7 @@ void OpcodeJbe(FemtoEmu_t *emu, bool verbose)
     {
         if (verbose == true) printf("JBE NOT TAKEN TO 0x%03X (PC = 0x%03X)\n", ADDR, PC);
     }
+    COVERAGE(emu)
 }
 
 void OpcodeJa(FemtoEmu_t *emu, bool verbose)
@@ -304,6 +481,7 @@ void OpcodeJa(FemtoEmu_t *emu, bool verbose)
     {
         if (verbose == true) printf("JA NOT TAKEN TO 0x%03X (PC = 0x%03X)\n", ADDR, PC);
     }
+    COVERAGE(emu)
 }
 
 void OpcodePush(FemtoEmu_t *emu, bool verbose)
@@ -338,6 +516,7 @@ void OpcodeCall(FemtoEmu_t *emu, bool verbose)
     StackPushByte(emu, pc_high);  /* PUSH HIGH PART OF PC */
     PC = ADDR;
     if (verbose == true) printf("CALL TO 0x%03X; LOW PC = 0x%02X & HIGH PC = 0x%01X\n", ADDR, pc_low, pc_high);
+    COVERAGE(emu)
 }
 
 void OpcodeRet(FemtoEmu_t *emu, bool verbose)
@@ -347,8 +526,8 @@ void OpcodeRet(FemtoEmu_t *emu, bool verbose)
     uint8_t pc_low  = StackPopByte(emu);
 
     PC = (pc_high << 8) | pc_low;
-    if (verbose == true) printf("RET TO 0x%03X; LOW PC = 0x%02X & HIGH PC = 0x%01X\n", PC, pc_low, pc_high); 
-
+    if (verbose == true) printf("RET TO 0x%03X; LOW PC = 0x%02X & HIGH PC = 0x%01X\n", PC, pc_low, pc_high);
+    COVERAGE(emu)
 }
 
 void OpcodeIn(FemtoEmu_t *emu, bool verbose)
@@ -356,13 +535,24 @@ void OpcodeIn(FemtoEmu_t *emu, bool verbose)
     /* IN REG, REG | IMM */
     if (ADRM == ADRM_IMM)
     {
-        R[DREG] = In(DATA);
-        if (verbose == true) printf("IN FROM PORT 0x%02X TO R%d (=0x%02X)\n", DATA, DREG, R[DREG]);
+        TEMP = In(DATA);
+        if (verbose == true) printf("IN FROM PORT 0x%02X TO R%d (=0x%02X)\n", DATA, DREG, TEMP);
+    }
+    else
+    {
+        TEMP = In(R[SREG]);
+        if (verbose == true) printf("IN FROM PORT R%d (=0x%02X) TO R%d (=0x%02X)\n", SREG, R[SREG], DREG, TEMP);
+    }
+
+    /* THE DEVICE HAS NO DATA YET (IOWait), REWIND TO RETRY THE INSTRUCTION WHEN THE CPU IS RESUMED */
+    if (WAIT)
+    {
+        PC -= 3;
+        if (verbose == true) printf("IN BLOCKED, CPU WAITING\n");
     }
     else
     {
-        R[DREG] = In(R[SREG]);
-        if (verbose == true) printf("IN FROM PORT R%d (=0x%02X) TO R%d (=0x%02X)\n", SREG, R[SREG], DREG, R[DREG]);
+        R[DREG] = (uint8_t)TEMP;
     }
 }
 
@@ -371,14 +561,21 @@ void OpcodeOut(FemtoEmu_t *emu, bool verbose)
     /* OUT REG | IMM, REG */
     if (ADRM == ADRM_IMM)
     {
-        Out(DATA, R[SREG]);
+        Out(R[SREG], DATA);
         if (verbose == true) printf("OUT TO PORT 0x%02X FROM R%d (=0x%02X)\n", DATA, SREG, R[SREG]);
     }
     else
     {
-        Out(R[DREG], R[SREG]);
+        Out(R[SREG], R[DREG]);
         if (verbose == true) printf("OUT TO PORT R%d (=0x%02X) FROM R%d (=0x%02X)\n", DREG, R[DREG], SREG, R[SREG]);
     }
+
+    /* THE DEVICE CAN'T ACCEPT DATA YET (IOWait), REWIND TO RETRY THE INSTRUCTION WHEN THE CPU IS RESUMED */
+    if (WAIT)
+    {
+        PC -= 3;
+        if (verbose == true) printf("OUT BLOCKED, CPU WAITING\n");
+    }
 }
 
 void OpcodeSys(FemtoEmu_t *emu, bool verbose)
@@ -386,6 +583,7 @@ void OpcodeSys(FemtoEmu_t *emu, bool verbose)
     /* SYS */
     if (verbose == true) printf("SYS : JUMP TO ADDRESS IN SYS VECTOR 0x002 (0x%03X)\n", GET_ADDR_VEC(SYS_VEC));
     SysReq(emu);
+    COVERAGE(emu)
 }
 
 void OpcodeSei(FemtoEmu_t *emu, bool verbose)
@@ -403,16 +601,186 @@ void OpcodeSdi(FemtoEmu_t *emu, bool verbose)
     if (verbose == true) printf("SDI : DISABLE INTERRUPT (IRQ) -> IFLAG = %d\n", IFLAG);
     PrintFlags(emu, verbose);
 }
+
+void OpcodeCas(FemtoEmu_t *emu, bool verbose)
+{
+    /* CAS REG, REG | IMM ==> IF RAM[ADDR] == R0 THEN RAM[ADDR] = REG (Z = 1) ELSE R0 = RAM[ADDR] (Z = 0) */
+    /* REGISTER MODE ADDRESSED LIKE LDM & STR: BASE REGISTER OR PAIR + OFFSET, POST-INCREMENT (common.h) */
+    uint16_t address = (ADRM == ADRM_IMM) ? ADDR : IndexAddress(emu, SREG, ADDR);
+    uint8_t  expect  = R[0];
+
+    MARK_DIRTY(address)
+    /* ACQUIRE & RELEASE FOR THE OTHER CORES SHARING THE RAM (smp.h), A LOCK CMPXCHG ON x86-64 */
+    if (__atomic_compare_exchange_n(&RAM[address], &expect, R[DREG], false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+    {
+        FLAGS = (FLAGS & 0x8) | 0x1;
+        if (verbose == true) printf("CAS: RAM[0x%03X] = R%d (0x%02X), EXCHANGED\n", address, DREG, R[DREG]);
+    }
+    else
+    {
+        FLAGS = (FLAGS & 0x8);
+        R[0]  = expect;
+        if (verbose == true) printf("CAS: RAM[0x%03X] (0x%02X) != R0, NOT EXCHANGED\n", address, expect);
+    }
+    if (ADRM == ADRM_REG) IndexIncrement(emu, SREG);
+    PrintFlags(emu, verbose);
+}
+
+void OpcodeAnd(FemtoEmu_t *emu, bool verbose)
+{
+    /* AND REG, REG | IMM */
+    uint8_t src = SrcOperand(emu);
+
+    TEMP = R[DREG];
+    R[DREG] &= src;
+    SetFlagsKeepI(emu, R[DREG]);
+    if (verbose == true) printf("AND: R%d (0x%02X) = 0x%02X & 0x%02X\n", DREG, R[DREG], TEMP, src);
+    PrintFlags(emu, verbose);
+}
+
+void OpcodeOr(FemtoEmu_t *emu, bool verbose)
+{
+    /* OR REG, REG | IMM */
+    uint8_t src = SrcOperand(emu);
+
+    TEMP = R[DREG];
+    R[DREG] |= src;
+    SetFlagsKeepI(emu, R[DREG]);
+    if (verbose == true) printf("OR: R%d (0x%02X) = 0x%02X | 0x%02X\n", DREG, R[DREG], TEMP, src);
+    PrintFlags(emu, verbose);
+}
+
+void OpcodeXor(FemtoEmu_t *emu, bool verbose)
+{
+    /* XOR REG, REG | IMM */
+    uint8_t src = SrcOperand(emu);
+
+    TEMP = R[DREG];
+    R[DREG] ^= src;
+    SetFlagsKeepI(emu, R[DREG]);
+    if (verbose == true) printf("XOR: R%d (0x%02X) = 0x%02X ^ 0x%02X\n", DREG, R[DREG], TEMP, src);
+    PrintFlags(emu, verbose);
+}
+
+void OpcodeNot(FemtoEmu_t *emu, bool verbose)
+{
+    /* NOT REG */
+    TEMP = R[DREG];
+    R[DREG] = (uint8_t)~R[DREG];
+    SetFlagsKeepI(emu, R[DREG]);
+    if (verbose == true) printf("NOT: R%d (0x%02X) = ~0x%02X\n", DREG, R[DREG], TEMP);
+    PrintFlags(emu, verbose);
+}
+
+void OpcodeShl(FemtoEmu_t *emu, bool verbose)
+{
+    /* SHL REG, REG | IMM ==> THE BITS SHIFTED OUT GIVE THE CARRY, AS AN ADD OVERFLOW */
+    uint8_t count = SrcOperand(emu) & 0x7;
+
+    TEMP = (int)R[DREG] << count;
+    SetFlagsKeepI(emu, TEMP);
+    R[DREG] = (uint8_t)TEMP;
+    if (verbose == true) printf("SHL: R%d (0x%02X) = 0x%02X << %d\n", DREG, R[DREG], TEMP >> count, count);
+    PrintFlags(emu, verbose);
+}
+
+void OpcodeShr(FemtoEmu_t *emu, bool verbose)
+{
+    /* SHR REG, REG | IMM ==> THE LAST BIT SHIFTED OUT GIVE THE CARRY, AS SHL */
+    uint8_t count = SrcOperand(emu) & 0x7;
+
+    TEMP = R[DREG];
+    R[DREG] >>= count;
+    SetFlagsKeepI(emu, R[DREG]);
+    if (count > 0 && ((TEMP >> (count - 1)) & 0x1)) FLAGS |= 0x2;
+    if (verbose == true) printf("SHR: R%d (0x%02X) = 0x%02X >> %d\n", DREG, R[DREG], TEMP, count);
+    PrintFlags(emu, verbose);
+}
+
+void OpcodeRol(FemtoEmu_t *emu, bool verbose)
+{
+    /* ROL REG, REG | IMM */
+    uint8_t count = SrcOperand(emu) & 0x7;
+
+    TEMP = R[DREG];
+    R[DREG] = (uint8_t)((TEMP << count) | (TEMP >> (8 - count)));
+    SetFlagsKeepI(emu, R[DREG]);
+    if (verbose == true) printf("ROL: R%d (0x%02X) = 0x%02X ROL %d\n", DREG, R[DREG], TEMP, count);
+    PrintFlags(emu, verbose);
+}
+
+void OpcodeRor(FemtoEmu_t *emu, bool verbose)
+{
+    /* ROR REG, REG | IMM */
+    uint8_t count = SrcOperand(emu) & 0x7;
+
+    TEMP = R[DREG];
+    R[DREG] = (uint8_t)((TEMP >> count) | (TEMP << (8 - count)));
+    SetFlagsKeepI(emu, R[DREG]);
+    if (verbose == true) printf("ROR: R%d (0x%02X) = 0x%02X ROR %d\n", DREG, R[DREG], TEMP, count);
+    PrintFlags(emu, verbose);
+}
+
+void OpcodeInc(FemtoEmu_t *emu, bool verbose)
+{
+    /* INC REG ==> FLAGS AS ADD REG, 1 */
+    TEMP = (int)R[DREG] + 1;
+    SetFlagsKeepI(emu, TEMP);
+    R[DREG] = (uint8_t)TEMP;
+    if (verbose == true) printf("INC: R%d = 0x%02X\n", DREG, R[DREG]);
+    PrintFlags(emu, verbose);
+}
+
+void OpcodeDec(FemtoEmu_t *emu, bool verbose)
+{
+    /* DEC REG ==> FLAGS AS SUB REG, 1 */
+    TEMP = (int)R[DREG] - 1;
+    SetFlagsKeepI(emu, TEMP);
+    R[DREG] = (uint8_t)TEMP;
+    if (verbose == true) printf("DEC: R%d = 0x%02X\n", DREG, R[DREG]);
+    PrintFlags(emu, verbose);
+}
+
+void OpcodeDjnz(FemtoEmu_t *emu, bool verbose)
+{
+    /* DJNZ REG, IMM ==> THE FLAGS ARE NOT CHANGED, SO THE LOOP BODY CAN TEST THEM ACROSS IT */
+    R[DREG]--;
+    if (R[DREG] != 0)
+    {
+        PC = ADDR;
+        if (verbose == true) printf("DJNZ: R%d = 0x%02X, TAKEN TO 0x%03X (PC = 0x%03X)\n", DREG, R[DREG], ADDR, PC);
+    }
+    else
+    {
+        if (verbose == true) printf("DJNZ: R%d = 0x%02X, NOT TAKEN TO 0x%03X (PC = 0x%03X)\n", DREG, R[DREG], ADDR, PC);
+    }
+    COVERAGE(emu)
+}
+
+void OpcodeBmov(FemtoEmu_t *emu, bool verbose)
+{
+    /* BMOV IMM | REG, REG, COUNT */
+    BlockExec(emu, verbose, false);
+}
+
+void OpcodeFill(FemtoEmu_t *emu, bool verbose)
+{
+    /* FILL IMM | REG, REG, COUNT */
+    BlockExec(emu, verbose, true);
+}
 /*** END OF OPCODE FUNCTIONS ***/
 
 
 /*** OPCODE FUNCTION POINTER ARRAY, BETTER THAN INTERPRETED OR SWITCH STATEMENT EMULATION ***/
-FemtoOpcode OpcodeFunc[0x20] =
+/*** THE OPCODE IS 7BITS WIDE, SO THE ARRAY COVER THE 0x80 VALUES ***/
+FemtoOpcode OpcodeFunc[0x80] =
 {
     OpcodeHlt,   OpcodeLdr,   OpcodeLdm,   OpcodeSti,   OpcodeStr,   OpcodeAdd,   OpcodeSub,   OpcodeCmp,
     OpcodeJz,    OpcodeJn,    OpcodeJc,    OpcodeJnc,   OpcodeJbe,   OpcodeJa,    OpcodeJmp,   OpcodeJnz,
     OpcodeJnn,   OpcodePush,  OpcodePop,   OpcodeCall,  OpcodeRet,   OpcodeIn,    OpcodeOut,   OpcodeSys,
-    OpcodeSei,   OpcodeSdi,   OpcodeError, OpcodeError, OpcodeError, OpcodeError, OpcodeError, OpcodeError
+    OpcodeSei,   OpcodeSdi,   OpcodeCas,   OpcodeAnd,   OpcodeOr,    OpcodeXor,   OpcodeNot,   OpcodeShl,
+    OpcodeShr,   OpcodeRol,   OpcodeRor,   OpcodeInc,   OpcodeDec,   OpcodeDjnz,  OpcodeBmov,  OpcodeFill,
+    [0x28 ... 0x7F] = OpcodeError
 };
 
 
@@ -420,9 +788,9 @@ void CpuExecInst(FemtoEmu_t *emu, bool verbose)
 {
      /* FETCH INSTRUCTION FROM RAM */
     if (verbose == true) printf("[0x%03X] ",  PC);
-    F[0] = RAM[(PC++ % 0xFFF)];
-    F[1] = RAM[(PC++ % 0xFFF)];
-    F[2] = RAM[(PC++ % 0xFFF)];
+    F[0] = RAM_LOAD(PC++ % 0xFFF);
+    F[1] = RAM_LOAD(PC++ % 0xFFF);
+    F[2] = RAM_LOAD(PC++ % 0xFFF);
 
     /* DECODE INSTRUCTION */
     INST =   F[0] & 0x7F;
@@ -435,4 +803,5 @@ void CpuExecInst(FemtoEmu_t *emu, bool verbose)
     /* EXECUTE INSTRUCTION, CALL THE APPROPRIATE FUNCTION THAT EMULATE THE OPCODE */
     (*OpcodeFunc[INST])(emu, verbose);
     TEMP = 0;
+    CYCLES++;
 }
\ No newline at end of file
@@ -29,6 +29,7 @@
 #define CPU_H_
 
 #include "../femto.h"
+#include "../common.h"
 
 
 #define DREG  emu->dreg
@@ -45,8 +46,66 @@
 #define HALT  emu->halt
 #define ADDR  emu->addr
 #define TEMP  emu->temp
+#define WAIT  emu->wait
+#define CYCLES emu->cycles
+#define STACK emu->stack
+#define FAULT emu->fault
+#define DIRTY emu->dirty
+
+#define FAULT_NONE     0
+#define FAULT_OPCODE   1   /* INVALID OPCODE */
+#define FAULT_ADRM     2   /* ILLEGAL ADDRESSING MODE */
+#define FAULT_STACK    3   /* STACK POINTER WRAPPED (OVERFLOW OR UNDERFLOW) */
+#define RAISE_FAULT(f) if (FAULT == FAULT_NONE) FAULT = (f);
+
+#define PAGE_SIZE      0x100       /* DIRTY PAGE GRANULARITY, 16 PAGES OF RAM */
+#define MARK_DIRTY(a)  DIRTY |= (uint16_t)(1u << (((a) >> 8) & 0xF));
+
+/* GUEST ACCESSES TO THE RAM, WHICH MAY BE SHARED BY THE CORES OF A SMP MACHINE (smp.h): RELAXED HOST
+ * ATOMICS, THE SAME PLAIN BYTE LOAD & STORE BUT THE COMPILER CAN'T MERGE, TEAR OR ELIDE THEM */
+#define RAM_LOAD(a)      __atomic_load_n(&RAM[(a)], __ATOMIC_RELAXED)
+#define RAM_STORE(a, v)  __atomic_store_n(&RAM[(a)], (uint8_t)(v), __ATOMIC_RELAXED)
+
+#define COV_SIZE       (1 << 16)   /* EDGE COVERAGE BITMAP SIZE, IN BYTES */
+#define COV_LINE       64          /* BYTES OF THE BITMAP PER BIT OF emu->cov_lines */
+#define COVERAGE(e)    if ((e)->cov != NULL) CovEdge(e);
+
+/* 12BITS VALUE OF THE PAIR R0:R1 (FOR R0 & R1) OR R2:R3 (FOR R2 & R3) */
+static inline uint16_t PairGet(const FemtoEmu_t *emu, uint8_t reg)
+{
+    return (uint16_t)(((R[reg & 0x2] & 0x0F) << 8) | R[(reg & 0x2) + 1]);
+}
+
+static inline void PairSet(FemtoEmu_t *emu, uint8_t reg, uint16_t value)
+{
+    R[reg & 0x2]       = (uint8_t)((value >> 8) & 0x0F);
+    R[(reg & 0x2) + 1] = (uint8_t)value;
+}
+
+/* ADDRESS OF THE REGISTER MODE OF LDM, STR & CAS, field IS THE 12BITS ADDRESS FIELD (XXXX OOOO OOOO) */
+static inline uint16_t IndexAddress(const FemtoEmu_t *emu, uint8_t reg, uint16_t field)
+{
+    uint16_t base = R[reg];
+
+    if ((field >> 8) & INDEX_PAIR) base = PairGet(emu, reg);
+    return (base + (field & 0xFF)) & 0xFFF;
+}
+
+/* DESTINATION & LENGTH OF BMOV & FILL, FROM THE DESCRIPTOR AT field (IMM) OR THE REGISTERS (REG) */
+static inline uint16_t BlockDest(const FemtoEmu_t *emu, bool adrm, uint8_t reg, uint16_t field, uint16_t *len)
+{
+    if (adrm == ADRM_REG)
+    {
+        *len = (field & 0xFF) ? (field & 0xFF) : 0x100;
+        return PairGet(emu, reg);
+    }
+
+    *len = (uint16_t)((RAM_LOAD((field + 4) & 0xFFF) << 8) | RAM_LOAD((field + 5) & 0xFFF));
+    return (uint16_t)(((RAM_LOAD(field & 0xFFF) & 0x0F) << 8) | RAM_LOAD((field + 1) & 0xFFF));
+}
 
 void CpuExecInst(FemtoEmu_t *emu, bool verbose);
+void CovEdge(FemtoEmu_t *emu);
 void StackPushByte(FemtoEmu_t *emu, uint8_t byte);
 uint8_t StackPopByte(FemtoEmu_t *emu);
 
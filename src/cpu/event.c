@@ -0,0 +1,168 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "event.h"
+
+
+/*** HELPING FUNCTIONS ***/
+static void EventSwap(FemtoEvent_t *a, FemtoEvent_t *b)
+{
+    FemtoEvent_t temp = *a;
+
+    *a = *b;
+    *b = temp;
+}
+
+static void EventSiftUp(FemtoEvents_t *ev, int i)
+{
+    while (i > 0 && ev->heap[(i - 1) / 2].cycle > ev->heap[i].cycle)
+    {
+        EventSwap(&ev->heap[(i - 1) / 2], &ev->heap[i]);
+        i = (i - 1) / 2;
+    }
+}
+
+static void EventSiftDown(FemtoEvents_t *ev, int i)
+{
+    while (true)
+    {
+        int min = i;
+        int l   = (2 * i) + 1;
+        int r   = (2 * i) + 2;
+
+        if (l < ev->count && ev->heap[l].cycle < ev->heap[min].cycle) min = l;
+        if (r < ev->count && ev->heap[r].cycle < ev->heap[min].cycle) min = r;
+        if (min == i) return;
+
+        EventSwap(&ev->heap[min], &ev->heap[i]);
+        i = min;
+    }
+}
+
+static void EventRemoveAt(FemtoEvents_t *ev, int i)
+{
+    ev->count--;
+    if (i == ev->count) return;
+
+    ev->heap[i] = ev->heap[ev->count];
+    EventSiftUp(ev, i);
+    EventSiftDown(ev, i);
+}
+
+static void EventUpdateDeadline(FemtoEmu_t *emu)
+{
+    FemtoEvents_t *ev = emu->events;
+
+    emu->next_event = (ev->count > 0) ? ev->heap[0].cycle : EVENT_NONE;
+}
+/*** END OF HELPING FUNCTIONS ***/
+
+
+/* SCHEDULE func(emu, arg) AT THE GUEST CYCLE cycle, RETURN THE ID OF THE EVENT */
+uint32_t EventAdd(FemtoEmu_t *emu, uint64_t cycle, EventFunc func, void *arg)
+{
+    FemtoEvents_t *ev = emu->events;
+
+    if (ev == NULL)
+    {
+        ev = calloc(1, sizeof(FemtoEvents_t));
+        if (ev == NULL)
+        {
+            printf("ERROR (EventAdd): CAN'T ALLOCATE EVENT QUEUE !!!\n");
+            exit(-1);
+        }
+        emu->events = ev;
+    }
+
+    if (ev->count == EVENT_MAX)
+    {
+        printf("ERROR (EventAdd): TOO MANY PENDING EVENTS (%d) !!!\n", EVENT_MAX);
+        exit(-1);
+    }
+
+    ev->heap[ev->count].cycle = cycle;
+    ev->heap[ev->count].id    = ++ev->next_id;
+    ev->heap[ev->count].func  = func;
+    ev->heap[ev->count].arg   = arg;
+    ev->count++;
+    EventSiftUp(ev, ev->count - 1);
+    EventUpdateDeadline(emu);
+
+    return ev->next_id;
+}
+
+
+bool EventCancel(FemtoEmu_t *emu, uint32_t id)
+{
+    FemtoEvents_t *ev = emu->events;
+
+    if (ev == NULL) return false;
+    for (int i = 0; i < ev->count; i++)
+    {
+        if (ev->heap[i].id != id) continue;
+
+        EventRemoveAt(ev, i);
+        EventUpdateDeadline(emu);
+        return true;
+    }
+    return false;
+}
+
+
+/* RUN EVERY EVENT WHICH DEADLINE IS REACHED, CALLED BY EmuStep WHEN cycles >= next_event */
+void EventRun(FemtoEmu_t *emu)
+{
+    FemtoEvents_t *ev = emu->events;
+
+    /* next_event MAY ALSO BE LOWERED BY THE BUFFERED OUT (IOFlushDeadline), WITH OR WITHOUT EVENT */
+    if (ev == NULL)
+    {
+        emu->next_event = EVENT_NONE;
+        return;
+    }
+
+    while (ev->count > 0 && ev->heap[0].cycle <= emu->cycles)
+    {
+        FemtoEvent_t event = ev->heap[0];
+
+        /* REMOVED BEFORE THE CALL, SO THE CALLBACK CAN SCHEDULE ITS NEXT EVENT */
+        EventRemoveAt(ev, 0);
+        EventUpdateDeadline(emu);
+        event.func(emu, event.arg);
+    }
+    EventUpdateDeadline(emu);
+}
+
+
+void EventQuit(FemtoEmu_t *emu)
+{
+    free(emu->events);
+    emu->events     = NULL;
+    emu->next_event = EVENT_NONE;
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+/* EVENT SCHEDULER:
+ * - EACH MACHINE HAS A BINARY MIN-HEAP OF EVENTS KEYED ON ITS GUEST CYCLE COUNT (emu->cycles)
+ * - emu->next_event CACHE THE CYCLE OF THE EARLIEST EVENT, SO EmuStep ONLY COMPARE IT WITH THE
+ *   CYCLE COUNT AND CALL EventRun WHEN THE DEADLINE IS REACHED
+ * - AN EVENT IS ONE-SHOT, A PERIODIC DEVICE SCHEDULE ITS NEXT EVENT FROM ITS CALLBACK
+ * - THE EVENTS OF A MACHINE ARE ONLY TOUCHED BY THE HOST THREAD RUNNING IT
+ */
+
+#ifndef EVENT_H_
+#define EVENT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../femto.h"
+
+#define EVENT_MAX    32           /* PENDING EVENTS PER MACHINE */
+#define EVENT_NONE   UINT64_MAX   /* emu->next_event WITH NO PENDING EVENT */
+
+
+typedef void (*EventFunc)(FemtoEmu_t *emu, void *arg);
+
+typedef struct FemtoEvent
+{
+    uint64_t   cycle;   /* DEADLINE */
+    uint32_t   id;      /* TO CANCEL THE EVENT */
+    EventFunc  func;
+    void      *arg;
+} FemtoEvent_t;
+
+typedef struct FemtoEvents
+{
+    FemtoEvent_t heap[EVENT_MAX];
+    int          count;
+    uint32_t     next_id;
+} FemtoEvents_t;
+
+
+uint32_t EventAdd(FemtoEmu_t *emu, uint64_t cycle, EventFunc func, void *arg);
+bool     EventCancel(FemtoEmu_t *emu, uint32_t id);
+void     EventRun(FemtoEmu_t *emu);
+void     EventQuit(FemtoEmu_t *emu);
+
+#endif
\ No newline at end of file
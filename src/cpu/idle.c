@@ -0,0 +1,167 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "cpu.h"
+#include "int.h"
+#include "idle.h"
+#include "event.h"
+#include "../common.h"
+#include "../io/io.h"
+
+
+/*** HELPING FUNCTIONS ***/
+/* THE BODY [start, branch] ONLY READ THE RAM, THE REGISTERS & THE POLLABLE PORTS */
+static bool IdleBodyIsPure(const FemtoEmu_t *emu, uint16_t start, uint16_t branch)
+{
+    if (branch < start || ((branch - start) % 3) != 0 || ((branch - start) / 3) >= IDLE_BODY_MAX) return false;
+
+    for (uint16_t a = start; a <= branch; a += 3)
+    {
+        uint8_t inst = RAM[a % 0xFFF] & 0x7F;
+        bool    adrm = (RAM[a % 0xFFF] & 0x80) != 0;
+
+        switch (inst)
+        {
+            case LDR: case LDM: case CMP:
+            case JZ:  case JN:  case JC:  case JNC: case JBE: case JA: case JMP: case JNZ: case JNN:
+                break;
+            case IN:
+                if (adrm == ADRM_REG || !IOIsPollable(RAM[(a + 2) % 0xFFF])) return false;
+                break;
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+/* THE LOOP CAN'T END BEFORE THE NEXT EVENT: SKIP THE ITERATIONS, OR WAIT FOR A HOST THREAD */
+static void IdleForward(FemtoEmu_t *emu, FemtoIdle_t *idle, uint64_t period)
+{
+    const struct timespec nap = { 0, IDLE_SLEEP_NS };
+
+    /* THE PENDING INTERRUPT WILL BE SERVED BY THE NEXT EmuStep */
+    if (CHK_IREQ(emu) && CHK_IRQ_ENABLE(emu)) return;
+
+    if (emu->next_event != EVENT_NONE)
+    {
+        /* WHOLE ITERATIONS ONLY, THE LAST ONE IS EXECUTED TO REACH THE EVENT AT ITS EXACT CYCLE */
+        uint64_t skip = ((emu->next_event - CYCLES) / period) * period;
+
+        CYCLES        += skip;
+        idle->skipped += skip;
+    }
+    else
+    {
+        nanosleep(&nap, NULL);
+        idle->sleeps++;
+    }
+}
+/*** END OF HELPING FUNCTIONS ***/
+
+
+void IdleInit(FemtoEmu_t *emu, bool verbose)
+{
+    emu->idle = calloc(1, sizeof(FemtoIdle_t));
+    if (emu->idle == NULL)
+    {
+        printf("ERROR (IdleInit): CAN'T ALLOCATE IDLE-LOOP DETECTOR !!!\n");
+        exit(-1);
+    }
+    if (verbose == true) printf("IDLE: POLLING LOOPS ARE FAST-FORWARDED\n");
+}
+
+
+/* CALLED BY EmuLoop AFTER EACH EmuStep, pc IS THE ADDRESS OF THE INSTRUCTION EXECUTED */
+void IdleCheck(FemtoEmu_t *emu, uint16_t pc)
+{
+    FemtoIdle_t *idle = emu->idle;
+
+    /* IN/OUT RETRIED: EACH RETRY IS ONE CYCLE */
+    if (WAIT)
+    {
+        if (emu->next_event != EVENT_NONE && CYCLES + 1 < emu->next_event)
+        {
+            idle->skipped += emu->next_event - 1 - CYCLES;
+            CYCLES         = emu->next_event - 1;
+        }
+        else if (emu->next_event == EVENT_NONE)
+        {
+            IdleForward(emu, idle, 1);
+        }
+        return;
+    }
+
+    /* ONLY A TAKEN BACKWARD BRANCH (NOT AN INTERRUPT) CAN CLOSE A LOOP */
+    if (INST < JZ || INST > JNN || ADRM != ADRM_IMM || PC != ADDR || PC > pc) return;
+
+    /* NO EVENT SINCE THE START OF THE ITERATION, IT MAY HAVE CHANGED WHAT THE NEXT ONE WILL READ */
+    if (idle->armed && idle->pc == PC && idle->branch == pc && CYCLES - idle->cycles <= IDLE_BODY_MAX &&
+        idle->next_event == emu->next_event && memcmp(idle->r, R, sizeof(idle->r)) == 0 && idle->flags == FLAGS)
+    {
+        uint64_t period = CYCLES - idle->cycles;
+
+        idle->loops++;
+        IdleForward(emu, idle, period);
+        idle->cycles     = CYCLES;
+        idle->next_event = emu->next_event;
+        return;
+    }
+
+    /* NEW CANDIDATE, CONFIRMED IF THE NEXT ITERATION DOES NOT CHANGE THE STATE */
+    idle->armed = IdleBodyIsPure(emu, PC, pc);
+    if (idle->armed)
+    {
+        idle->pc         = PC;
+        idle->branch     = pc;
+        idle->flags      = FLAGS;
+        idle->cycles     = CYCLES;
+        idle->next_event = emu->next_event;
+        memcpy(idle->r, R, sizeof(idle->r));
+    }
+}
+
+
+void IdleReport(const FemtoEmu_t *emu)
+{
+    FemtoIdle_t *idle = emu->idle;
+
+    if (idle == NULL) return;
+    printf("IDLE: %llu IDLE ITERATIONS, %llu CYCLES FAST-FORWARDED, %llu HOST SLEEPS\n",
+           (unsigned long long)idle->loops, (unsigned long long)idle->skipped, (unsigned long long)idle->sleeps);
+}
+
+
+void IdleQuit(FemtoEmu_t *emu)
+{
+    free(emu->idle);
+    emu->idle = NULL;
+}
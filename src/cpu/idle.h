@@ -0,0 +1,70 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+/* IDLE-LOOP DETECTION:
+ * - A POLLING LOOP IS A BACKWARD BRANCH WHICH BODY (AT MOST IDLE_BODY_MAX INSTRUCTIONS) ONLY
+ *   READ: LDR, LDM, CMP, IN FROM A POLLABLE PORT (IOPollable) AND CONDITIONAL OR NOT JUMPS
+ * - IT IS IDLE WHEN AN ITERATION BRING BACK THE REGISTERS & THE FLAGS TO THE SAME VALUES: THE
+ *   NEXT ITERATIONS ARE THE SAME UNTIL A DEVICE CHANGE
+ * - AN IDLE LOOP IS FAST-FORWARDED BY WHOLE ITERATIONS UP TO THE NEXT EVENT, SO THE CYCLE COUNT
+ *   IS THE ONE OF THE SPINNING GUEST; WITHOUT EVENT, ONLY A HOST THREAD CAN END IT (STREAM, IPI,
+ *   ...), THE HOST THREAD SLEEP IDLE_SLEEP_NS BETWEEN TWO ITERATIONS
+ * - AN IN/OUT RETRIED (IOWait) IS HANDLED THE SAME WAY, ONE CYCLE PER RETRY
+ */
+
+#ifndef IDLE_H_
+#define IDLE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../femto.h"
+
+#define IDLE_BODY_MAX   16        /* INSTRUCTIONS OF A POLLING LOOP */
+#define IDLE_SLEEP_NS   100000    /* 100us */
+
+
+typedef struct FemtoIdle
+{
+    uint16_t  pc;        /* TARGET OF THE BACKWARD BRANCH (START OF THE LOOP) */
+    uint16_t  branch;    /* ADDRESS OF THE BACKWARD BRANCH */
+    uint8_t   r[4];      /* STATE AT THE START OF THE LAST ITERATION */
+    uint8_t   flags;
+    uint64_t  cycles;
+    uint64_t  next_event;
+    bool      armed;
+    uint64_t  loops;     /* IDLE ITERATIONS DETECTED */
+    uint64_t  skipped;   /* GUEST CYCLES FAST-FORWARDED */
+    uint64_t  sleeps;    /* HOST SLEEPS */
+} FemtoIdle_t;
+
+
+void IdleInit(FemtoEmu_t *emu, bool verbose);
+void IdleCheck(FemtoEmu_t *emu, uint16_t pc);
+void IdleReport(const FemtoEmu_t *emu);
+void IdleQuit(FemtoEmu_t *emu);
+
+#endif
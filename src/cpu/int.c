@@ -29,14 +29,101 @@
 #include "../femto.h"
 #include "cpu.h"
 #include "int.h"
+#include "../io/io.h"
 
 
+/*** IO CALLBACKS OF THE INTERRUPT CONTROLLER (emu : MACHINE DOING THE IN/OUT, NULL IF NONE IS BOUND) ***/
+static uint8_t IntcMaskIn(FemtoEmu_t *emu, void *ctx, uint8_t io_port)
+{
+    (void)ctx; (void)io_port;
+    return (emu == NULL) ? 0xFF : emu->imask;
+}
+
+static void IntcMaskOut(FemtoEmu_t *emu, void *ctx, uint8_t io_port, uint8_t data)
+{
+    (void)ctx; (void)io_port;
+    if (emu != NULL) emu->imask = data;
+}
+
+static uint8_t IntcPendIn(FemtoEmu_t *emu, void *ctx, uint8_t io_port)
+{
+    (void)ctx; (void)io_port;
+    return (emu == NULL) ? 0x00 : __atomic_load_n(&emu->ireq, __ATOMIC_ACQUIRE);
+}
+
+static void IntcPendOut(FemtoEmu_t *emu, void *ctx, uint8_t io_port, uint8_t data)
+{
+    (void)ctx; (void)io_port;
+    if (emu != NULL) __atomic_fetch_and(&emu->ireq, (uint8_t)~data, __ATOMIC_ACQ_REL);
+}
+
+static uint8_t IntcLineIn(FemtoEmu_t *emu, void *ctx, uint8_t io_port)
+{
+    (void)ctx; (void)io_port;
+    return (emu == NULL) ? 0x00 : emu->iline;
+}
+
+static void IntcLineOut(FemtoEmu_t *emu, void *ctx, uint8_t io_port, uint8_t data)
+{
+    (void)ctx; (void)io_port;
+    if (emu != NULL) emu->isel = data & (IRQ_LINES - 1);
+}
+
+static void IntcVecLow(FemtoEmu_t *emu, void *ctx, uint8_t io_port, uint8_t data)
+{
+    uint16_t vec = 0;
+
+    (void)ctx; (void)io_port;
+    if (emu == NULL) return;
+
+    vec = (emu->ivec[emu->isel] == IRQ_VEC_RAM) ? 0 : emu->ivec[emu->isel];
+
+    emu->ivec[emu->isel] = (vec & 0x0F00) | data;
+}
+
+static void IntcVecHigh(FemtoEmu_t *emu, void *ctx, uint8_t io_port, uint8_t data)
+{
+    uint16_t vec = 0;
+
+    (void)ctx; (void)io_port;
+    if (emu == NULL) return;
+
+    vec = (emu->ivec[emu->isel] == IRQ_VEC_RAM) ? 0 : emu->ivec[emu->isel];
+
+    emu->ivec[emu->isel] = (data == 0xFF) ? IRQ_VEC_RAM : (uint16_t)(((data & 0x0F) << 8) | (vec & 0x00FF));
+}
+/*** END OF IO CALLBACKS ***/
+
+
+/* MUST BE CALLED AFTER IOInit() */
+void IntInit(void)
+{
+    IORegisterIn(INTC_MASK_PORT, IntcMaskIn, NULL);
+    IORegisterOut(INTC_MASK_PORT, IntcMaskOut, NULL);
+    IORegisterIn(INTC_PEND_PORT, IntcPendIn, NULL);
+    IORegisterOut(INTC_PEND_PORT, IntcPendOut, NULL);
+    IORegisterIn(INTC_LINE_PORT, IntcLineIn, NULL);
+    IORegisterOut(INTC_LINE_PORT, IntcLineOut, NULL);
+    IORegisterOut(INTC_VECL_PORT, IntcVecLow, NULL);
+    IORegisterOut(INTC_VECH_PORT, IntcVecHigh, NULL);
+    IOPollable(INTC_MASK_PORT);
+    IOPollable(INTC_PEND_PORT);
+    IOPollable(INTC_LINE_PORT);
+}
+
+
+/* SERVE THE PENDING & ENABLED LINE OF HIGHEST PRIORITY (LOWEST NUMBER) */
 void IntReq(FemtoEmu_t *emu)
 {
-    if (CHK_IRQ_ENABLE(emu))
+    uint8_t pending = __atomic_load_n(&emu->ireq, __ATOMIC_ACQUIRE) & emu->imask;
+
+    if (CHK_IRQ_ENABLE(emu) && pending != 0)
     {
+        uint8_t line = (uint8_t)__builtin_ctz(pending);
+
         /* ACKNOWLEDGE OF THE IRQ */
-        RES_IREQ(emu)
+        RES_IREQ(emu, line)
+        emu->iline = line;
 
         /* PUSH PC ON THE STACK, LOW THEN HIGH PART */
         uint8_t pc_low  = (uint8_t)(PC & 0x00FF);
@@ -45,8 +132,9 @@ void IntReq(FemtoEmu_t *emu)
         StackPushByte(emu, pc_low);   /* PUSH LOW PART OF PC */
         StackPushByte(emu, pc_high);  /* PUSH HIGH PART OF PC */
 
-        /* GOTO TO THE ADDRESS STORE IN THE IRQ VECTOR */
-        PC = GET_ADDR_VEC(IREQ_VEC);
+        /* GOTO TO THE VECTOR OF THE LINE, OR TO THE ADDRESS STORE IN THE IRQ VECTOR */
+        PC = (emu->ivec[line] == IRQ_VEC_RAM) ? (uint16_t)(GET_ADDR_VEC(IREQ_VEC)) : emu->ivec[line];
+        COVERAGE(emu)
     }
 }
 
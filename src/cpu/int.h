@@ -33,16 +33,29 @@
 
 #define IREQ_VEC        0x000   /* IREQ VECTOR (WHEN IREQ, JUMP TO ADDRESS CONTAIN IN THIS VECTOR) ==> ADDRESS IS STORED BIG-ENDIAN */
 #define SYS_VEC         0x002   /* SYS  VECTOR (WHEN SYS INSTRUCTION, JUMP TO ADDRESS IN THIS VECTOR) ==> ADDRESS IS STORED BIG-ENDIAN */
-#define GET_ADDR_VEC(v) (RAM[v + 1] << 8) | RAM[v]
+#define GET_ADDR_VEC(v) (RAM_LOAD(v + 1) << 8) | RAM_LOAD(v)
 
 
-#define IREQ(e)               e->ireq = true;
-#define RES_IREQ(e)           e->ireq = false;
-#define CHK_IREQ(e)          (e->ireq == true)
+/* INTERRUPT CONTROLLER: 8 LINES, LINE 0 HAS THE HIGHEST PRIORITY */
+#define IRQ_LINES        8
+#define IRQ_VEC_RAM      0xFFFF  /* VECTOR OF A LINE NOT PROGRAMMED: ADDRESS STORED AT IREQ_VEC */
+
+#define INTC_MASK_PORT   0xE0    /* IN/OUT : ENABLED LINES (BIT n : LINE n) */
+#define INTC_PEND_PORT   0xE1    /* IN : PENDING LINES; OUT : CLEAR THE PENDING LINES WHICH BITS ARE SET */
+#define INTC_LINE_PORT   0xE2    /* IN : LAST LINE SERVED; OUT : SELECT THE LINE OF THE NEXT VECTOR WRITE */
+#define INTC_VECL_PORT   0xE3    /* OUT : VECTOR OF THE SELECTED LINE, LOW BYTE */
+#define INTC_VECH_PORT   0xE4    /* OUT : VECTOR OF THE SELECTED LINE, HIGH 4 BITS (0xFF : BACK TO IREQ_VEC) */
+
+/* LOCK-FREE, ANY HOST THREAD CAN RAISE A LINE; THE CPU TEST ALL THE LINES WITH A SINGLE LOAD */
+#define IREQ_LINE(e, l)       __atomic_fetch_or(&(e)->ireq, (uint8_t)(1u << (l)), __ATOMIC_RELEASE);
+#define IREQ(e)               IREQ_LINE(e, 0)
+#define RES_IREQ(e, l)        __atomic_fetch_and(&(e)->ireq, (uint8_t)~(1u << (l)), __ATOMIC_ACQ_REL);
+#define CHK_IREQ(e)          ((__atomic_load_n(&(e)->ireq, __ATOMIC_ACQUIRE) & (e)->imask) != 0)
 #define CHK_IRQ_ENABLE(e)  (((e->flags >> 3) & 0x1) == 1)
 #define ENABLE_IRQ(e)        e->flags |= 1 << 3;
 #define DISABLE_IRQ(e)       e->flags &= ~(1 << 3);
 
+void IntInit(void);
 void IntReq(FemtoEmu_t *emu);
 void SysReq(FemtoEmu_t *emu);
 
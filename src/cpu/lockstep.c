@@ -0,0 +1,748 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "cpu.h"
+#include "int.h"
+#include "lockstep.h"
+#include "../common.h"
+#include "../io/io.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LOCKSTEP_X86
+#endif
+
+#define LOCKSTEP_IRQ_POLL  256  /* VECTOR STEPS BETWEEN TWO SCANS OF THE LANES INTERRUPT REQUESTS */
+
+
+/*** VECTOR KERNELS: EACH ONE PROCESS ALL THE (PADDED) LANES, INACTIVE LANES ARE LEFT UNTOUCHED ***/
+typedef struct LockstepKernels
+{
+    const char *name;
+    void (*ldi)(uint8_t *d, uint8_t data, const uint8_t *mask, int n);
+    void (*ldr)(uint8_t *d, const uint8_t *s, const uint8_t *mask, int n);
+    void (*add)(uint8_t *d, const uint8_t *s, uint8_t *flags, const uint8_t *mask, int n);
+    void (*sub)(uint8_t *d, const uint8_t *s, uint8_t *flags, const uint8_t *mask, int n, bool write);
+    int  (*jcc)(const uint8_t *flags, uint8_t bits, bool set, const uint8_t *mask, uint8_t *take, int n);
+} LockstepKernels_t;
+
+
+/* GENERIC KERNELS, SAME SEMANTIC AS OpcodeLdr/OpcodeAdd/OpcodeSub/OpcodeCmp & UpdateFlags */
+static void LdiGeneric(uint8_t *d, uint8_t data, const uint8_t *mask, int n)
+{
+    for (int i = 0; i < n; i++) if (mask[i]) d[i] = data;
+}
+
+static void LdrGeneric(uint8_t *d, const uint8_t *s, const uint8_t *mask, int n)
+{
+    for (int i = 0; i < n; i++) if (mask[i]) d[i] = s[i];
+}
+
+static void AddGeneric(uint8_t *d, const uint8_t *s, uint8_t *flags, const uint8_t *mask, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        if (!mask[i]) continue;
+        int temp = (int)d[i] + (int)s[i];
+        flags[i] = (flags[i] & 0x8) | ((temp == 0) ? 0x1 : (temp > 0xFF) ? 0x2 : 0x0);
+        d[i] = (uint8_t)temp;
+    }
+}
+
+static void SubGeneric(uint8_t *d, const uint8_t *s, uint8_t *flags, const uint8_t *mask, int n, bool write)
+{
+    for (int i = 0; i < n; i++)
+    {
+        if (!mask[i]) continue;
+        int temp = (int)d[i] - (int)s[i];
+        flags[i] = (flags[i] & 0x8) | ((temp == 0) ? 0x1 : (temp < 0) ? 0x4 : 0x0);
+        if (write) d[i] = (uint8_t)temp;
+    }
+}
+
+static int JccGeneric(const uint8_t *flags, uint8_t bits, bool set, const uint8_t *mask, uint8_t *take, int n)
+{
+    int taken = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        take[i] = (((flags[i] & bits) != 0) == set) ? mask[i] : 0x00;
+        taken  += (take[i] != 0);
+    }
+    return taken;
+}
+
+static const LockstepKernels_t KernelsGeneric = {"GENERIC", LdiGeneric, LdrGeneric, AddGeneric, SubGeneric, JccGeneric};
+
+
+#ifdef LOCKSTEP_X86
+/* SSE2 KERNELS (16 LANES PER ITERATION), SSE2 IS THE x86-64 BASELINE */
+#define BLEND128(m, n, o) _mm_or_si128(_mm_and_si128(m, n), _mm_andnot_si128(m, o))
+
+__attribute__((target("sse2")))
+static void LdiSse2(uint8_t *d, uint8_t data, const uint8_t *mask, int n)
+{
+    const __m128i v = _mm_set1_epi8((char)data);
+
+    for (int i = 0; i < n; i += 16)
+    {
+        __m128i m = _mm_load_si128((const __m128i *)(mask + i));
+        __m128i a = _mm_load_si128((const __m128i *)(d + i));
+        _mm_store_si128((__m128i *)(d + i), BLEND128(m, v, a));
+    }
+}
+
+__attribute__((target("sse2")))
+static void LdrSse2(uint8_t *d, const uint8_t *s, const uint8_t *mask, int n)
+{
+    for (int i = 0; i < n; i += 16)
+    {
+        __m128i m = _mm_load_si128((const __m128i *)(mask + i));
+        __m128i a = _mm_load_si128((const __m128i *)(d + i));
+        __m128i b = _mm_load_si128((const __m128i *)(s + i));
+        _mm_store_si128((__m128i *)(d + i), BLEND128(m, b, a));
+    }
+}
+
+__attribute__((target("sse2")))
+static void AddSse2(uint8_t *d, const uint8_t *s, uint8_t *flags, const uint8_t *mask, int n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi8((char)0xFF);
+    const __m128i zf   = _mm_set1_epi8(0x1);
+    const __m128i cf   = _mm_set1_epi8(0x2);
+    const __m128i irq  = _mm_set1_epi8(0x8);
+
+    for (int i = 0; i < n; i += 16)
+    {
+        __m128i m   = _mm_load_si128((const __m128i *)(mask + i));
+        __m128i a   = _mm_load_si128((const __m128i *)(d + i));
+        __m128i b   = _mm_load_si128((const __m128i *)(s + i));
+        __m128i f   = _mm_load_si128((const __m128i *)(flags + i));
+        __m128i res = _mm_add_epi8(a, b);
+
+        /* ZERO ONLY IF BOTH OPERANDS ARE ZERO; CARRY IF THE 8BITS RESULT WRAPPED (res < a) */
+        __m128i z = _mm_cmpeq_epi8(_mm_or_si128(a, b), zero);
+        __m128i c = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_max_epu8(res, a), res), ones);
+        __m128i nf = _mm_or_si128(_mm_and_si128(z, zf), _mm_and_si128(_mm_andnot_si128(z, c), cf));
+
+        nf = _mm_or_si128(nf, _mm_and_si128(f, irq));   /* KEEP THE I FLAG */
+
+        _mm_store_si128((__m128i *)(d + i), BLEND128(m, res, a));
+        _mm_store_si128((__m128i *)(flags + i), BLEND128(m, nf, f));
+    }
+}
+
+__attribute__((target("sse2")))
+static void SubSse2(uint8_t *d, const uint8_t *s, uint8_t *flags, const uint8_t *mask, int n, bool write)
+{
+    const __m128i zf = _mm_set1_epi8(0x1);
+    const __m128i nf = _mm_set1_epi8(0x4);
+    const __m128i irq = _mm_set1_epi8(0x8);
+
+    for (int i = 0; i < n; i += 16)
+    {
+        __m128i m   = _mm_load_si128((const __m128i *)(mask + i));
+        __m128i a   = _mm_load_si128((const __m128i *)(d + i));
+        __m128i b   = _mm_load_si128((const __m128i *)(s + i));
+        __m128i f   = _mm_load_si128((const __m128i *)(flags + i));
+
+        /* ZERO IF a == b; NEGATIVE IF a < b (UNSIGNED) */
+        __m128i z  = _mm_cmpeq_epi8(a, b);
+        __m128i lt = _mm_andnot_si128(z, _mm_cmpeq_epi8(_mm_max_epu8(a, b), b));
+        __m128i fl = _mm_or_si128(_mm_and_si128(z, zf), _mm_and_si128(lt, nf));
+
+        fl = _mm_or_si128(fl, _mm_and_si128(f, irq));
+
+        if (write) _mm_store_si128((__m128i *)(d + i), BLEND128(m, _mm_sub_epi8(a, b), a));
+        _mm_store_si128((__m128i *)(flags + i), BLEND128(m, fl, f));
+    }
+}
+
+__attribute__((target("sse2,popcnt")))
+static int JccSse2(const uint8_t *flags, uint8_t bits, bool set, const uint8_t *mask, uint8_t *take, int n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i vb   = _mm_set1_epi8((char)bits);
+    int taken = 0;
+
+    for (int i = 0; i < n; i += 16)
+    {
+        __m128i m = _mm_load_si128((const __m128i *)(mask + i));
+        __m128i f = _mm_load_si128((const __m128i *)(flags + i));
+        __m128i clr = _mm_cmpeq_epi8(_mm_and_si128(f, vb), zero);
+        __m128i t   = set ? _mm_andnot_si128(clr, m) : _mm_and_si128(clr, m);
+
+        _mm_store_si128((__m128i *)(take + i), t);
+        taken += _mm_popcnt_u32((unsigned)_mm_movemask_epi8(t));
+    }
+    return taken;
+}
+
+static const LockstepKernels_t KernelsSse2 = {"SSE2", LdiSse2, LdrSse2, AddSse2, SubSse2, JccSse2};
+
+
+/* AVX2 KERNELS (32 LANES PER ITERATION), SELECTED AT RUNTIME */
+#define BLEND256(m, n, o) _mm256_blendv_epi8(o, n, m)
+
+__attribute__((target("avx2")))
+static void LdiAvx2(uint8_t *d, uint8_t data, const uint8_t *mask, int n)
+{
+    const __m256i v = _mm256_set1_epi8((char)data);
+
+    for (int i = 0; i < n; i += 32)
+    {
+        __m256i m = _mm256_load_si256((const __m256i *)(mask + i));
+        __m256i a = _mm256_load_si256((const __m256i *)(d + i));
+        _mm256_store_si256((__m256i *)(d + i), BLEND256(m, v, a));
+    }
+}
+
+__attribute__((target("avx2")))
+static void LdrAvx2(uint8_t *d, const uint8_t *s, const uint8_t *mask, int n)
+{
+    for (int i = 0; i < n; i += 32)
+    {
+        __m256i m = _mm256_load_si256((const __m256i *)(mask + i));
+        __m256i a = _mm256_load_si256((const __m256i *)(d + i));
+        __m256i b = _mm256_load_si256((const __m256i *)(s + i));
+        _mm256_store_si256((__m256i *)(d + i), BLEND256(m, b, a));
+    }
+}
+
+__attribute__((target("avx2")))
+static void AddAvx2(uint8_t *d, const uint8_t *s, uint8_t *flags, const uint8_t *mask, int n)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi8((char)0xFF);
+    const __m256i zf   = _mm256_set1_epi8(0x1);
+    const __m256i cf   = _mm256_set1_epi8(0x2);
+    const __m256i irq  = _mm256_set1_epi8(0x8);
+
+    for (int i = 0; i < n; i += 32)
+    {
+        __m256i m   = _mm256_load_si256((const __m256i *)(mask + i));
+        __m256i a   = _mm256_load_si256((const __m256i *)(d + i));
+        __m256i b   = _mm256_load_si256((const __m256i *)(s + i));
+        __m256i f   = _mm256_load_si256((const __m256i *)(flags + i));
+        __m256i res = _mm256_add_epi8(a, b);
+
+        __m256i z  = _mm256_cmpeq_epi8(_mm256_or_si256(a, b), zero);
+        __m256i c  = _mm256_andnot_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(res, a), res), ones);
+        __m256i nf = _mm256_or_si256(_mm256_and_si256(z, zf), _mm256_and_si256(_mm256_andnot_si256(z, c), cf));
+
+        nf = _mm256_or_si256(nf, _mm256_and_si256(f, irq));
+
+        _mm256_store_si256((__m256i *)(d + i), BLEND256(m, res, a));
+        _mm256_store_si256((__m256i *)(flags + i), BLEND256(m, nf, f));
+    }
+}
+
+__attribute__((target("avx2")))
+static void SubAvx2(uint8_t *d, const uint8_t *s, uint8_t *flags, const uint8_t *mask, int n, bool write)
+{
+    const __m256i zf = _mm256_set1_epi8(0x1);
+    const __m256i nf = _mm256_set1_epi8(0x4);
+    const __m256i irq = _mm256_set1_epi8(0x8);
+
+    for (int i = 0; i < n; i += 32)
+    {
+        __m256i m   = _mm256_load_si256((const __m256i *)(mask + i));
+        __m256i a   = _mm256_load_si256((const __m256i *)(d + i));
+        __m256i b   = _mm256_load_si256((const __m256i *)(s + i));
+        __m256i f   = _mm256_load_si256((const __m256i *)(flags + i));
+
+        __m256i z  = _mm256_cmpeq_epi8(a, b);
+        __m256i lt = _mm256_andnot_si256(z, _mm256_cmpeq_epi8(_mm256_max_epu8(a, b), b));
+        __m256i fl = _mm256_or_si256(_mm256_and_si256(z, zf), _mm256_and_si256(lt, nf));
+
+        fl = _mm256_or_si256(fl, _mm256_and_si256(f, irq));
+
+        if (write) _mm256_store_si256((__m256i *)(d + i), BLEND256(m, _mm256_sub_epi8(a, b), a));
+        _mm256_store_si256((__m256i *)(flags + i), BLEND256(m, fl, f));
+    }
+}
+
+__attribute__((target("avx2,popcnt")))
+static int JccAvx2(const uint8_t *flags, uint8_t bits, bool set, const uint8_t *mask, uint8_t *take, int n)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i vb   = _mm256_set1_epi8((char)bits);
+    int taken = 0;
+
+    for (int i = 0; i < n; i += 32)
+    {
+        __m256i m = _mm256_load_si256((const __m256i *)(mask + i));
+        __m256i f = _mm256_load_si256((const __m256i *)(flags + i));
+        __m256i clr = _mm256_cmpeq_epi8(_mm256_and_si256(f, vb), zero);
+        __m256i t   = set ? _mm256_andnot_si256(clr, m) : _mm256_and_si256(clr, m);
+
+        _mm256_store_si256((__m256i *)(take + i), t);
+        taken += _mm_popcnt_u32((unsigned)_mm256_movemask_epi8(t));
+    }
+    return taken;
+}
+
+static const LockstepKernels_t KernelsAvx2 = {"AVX2", LdiAvx2, LdrAvx2, AddAvx2, SubAvx2, JccAvx2};
+#endif
+
+static const LockstepKernels_t *Kernels = &KernelsGeneric;
+/*** END OF VECTOR KERNELS ***/
+
+
+
+/*** HELPING FUNCTIONS ***/
+static void LaneLoad(FemtoLockstep_t *ls, int i, uint16_t pc)
+{
+    FemtoEmu_t *emu = ls->lane[i];
+
+    PC    = pc;
+    R[0]  = ls->r[0][i];
+    R[1]  = ls->r[1][i];
+    R[2]  = ls->r[2][i];
+    R[3]  = ls->r[3][i];
+    SP    = ls->sp[i];
+    FLAGS = ls->flags[i];
+}
+
+static void LaneStore(FemtoLockstep_t *ls, int i)
+{
+    FemtoEmu_t *emu = ls->lane[i];
+
+    ls->r[0][i]  = R[0];
+    ls->r[1][i]  = R[1];
+    ls->r[2][i]  = R[2];
+    ls->r[3][i]  = R[3];
+    ls->sp[i]    = SP;
+    ls->flags[i] = FLAGS;
+}
+
+/* THE LANE LEAVE THE LOCKSTEP; ITS MACHINE MUST ALREADY HOLD ITS UP TO DATE STATE */
+static void LaneDrop(FemtoLockstep_t *ls, int i, bool halted)
+{
+    ls->mask[i]    = 0x00;
+    ls->dropped[i] = !halted;
+    ls->active--;
+}
+
+/* TRUE IF THE INSTRUCTION AT PC WOULD WRITE INTO THE SHARED CODE OF THIS LANE */
+static bool LaneWritesCode(FemtoLockstep_t *ls, FemtoEmu_t *emu)
+{
+    uint8_t  f0   = RAM[PC % 0xFFF];
+    uint8_t  f1   = RAM[(PC + 1) % 0xFFF];
+    uint8_t  f2   = RAM[(PC + 2) % 0xFFF];
+    bool     adrm = (f0 & 0x80) >> 7;
+    uint8_t  dreg = (f1 >> 6) & 0x03;
+    uint8_t  sreg = (f1 >> 4) & 0x03;
+    uint16_t addr = ((f1 & 0x0F) << 8) | f2;
+    uint16_t len  = 0;
+    uint16_t dst  = 0;
+
+    switch (f0 & 0x7F)
+    {
+        case STI:  return R[dreg] < ls->rom_size;
+        case STR:  return ((adrm == ADRM_IMM) ? addr : IndexAddress(emu, dreg, addr)) < ls->rom_size;
+        case CAS:  return ((adrm == ADRM_IMM) ? addr : IndexAddress(emu, sreg, addr)) < ls->rom_size;
+        case PUSH: return (STACK + SP) < ls->rom_size;
+        case CALL:
+        case SYS:  return (STACK + ((SP + 1) & 0xFF)) < ls->rom_size || (STACK + SP) < ls->rom_size;
+        case BMOV:
+        case FILL: dst = BlockDest(emu, adrm, dreg, addr, &len);
+                   return dst < ls->rom_size || dst + len > 0x1000 || (adrm == ADRM_IMM && addr < ls->rom_size);
+        default:   return false;
+    }
+}
+
+/* KEEP THE LANES THAT AGREE WITH THE MOST FREQUENT PC, DROP THE OTHERS */
+static uint16_t LockstepVote(FemtoLockstep_t *ls, const uint16_t *npc)
+{
+    uint16_t cand  = 0;
+    int      count = 0;
+
+    /* BOYER-MOORE MAJORITY VOTE, THE CANDIDATE IS ONLY THE MAJORITY IF A 2ND PASS COUNT IT IN MORE THAN HALF */
+    for (int i = 0; i < ls->lanes; i++)
+    {
+        if (!ls->mask[i]) continue;
+        if (count == 0) cand = npc[i];
+        count += (npc[i] == cand) ? 1 : -1;
+    }
+
+    count = 0;
+    for (int i = 0; i < ls->lanes; i++)
+    {
+        if (ls->mask[i] && npc[i] == cand) count++;
+    }
+
+    /* NO STRICT MAJORITY: COUNT EVERY PC, KEEP THE MOST FREQUENT (THE 1ST LANE'S ON A TIE) */
+    if (count * 2 <= ls->active)
+    {
+        uint16_t votes[0x1000];
+        int      best = 0;
+
+        memset(votes, 0, sizeof(votes));
+        for (int i = 0; i < ls->lanes; i++)
+        {
+            if (ls->mask[i]) votes[npc[i] & 0xFFF]++;
+        }
+        for (int i = 0; i < ls->lanes; i++)
+        {
+            if (!ls->mask[i] || votes[npc[i] & 0xFFF] <= best) continue;
+            best = votes[npc[i] & 0xFFF];
+            cand = npc[i];
+        }
+    }
+
+    for (int i = 0; i < ls->lanes; i++)
+    {
+        if (ls->mask[i] && npc[i] != cand)
+        {
+            LaneLoad(ls, i, npc[i]);
+            LaneDrop(ls, i, false);
+        }
+    }
+    return cand;
+}
+
+/* EXECUTE THE INSTRUCTION AT THE SHARED PC LANE BY LANE WITH THE SCALAR CPU */
+static void LockstepScalarStep(FemtoLockstep_t *ls, uint16_t *npc, bool verbose)
+{
+    for (int i = 0; i < ls->lanes; i++)
+    {
+        if (!ls->mask[i]) continue;
+
+        FemtoEmu_t *emu = ls->lane[i];
+        LaneLoad(ls, i, ls->pc);
+
+        /* A LANE THAT MODIFY ITS CODE DIVERGE, LET IT EXECUTE THE STORE ON THE SCALAR PATH */
+        if (LaneWritesCode(ls, emu))
+        {
+            LaneDrop(ls, i, false);
+            continue;
+        }
+
+        IOBind(emu);
+        CpuExecInst(emu, verbose);
+        ls->lane_inst++;
+
+        if (HALT)
+        {
+            LaneDrop(ls, i, true);
+        }
+        else if (CHK_IREQ(emu) && CHK_IRQ_ENABLE(emu))
+        {
+            LaneDrop(ls, i, false);
+        }
+        else
+        {
+            LaneStore(ls, i);
+            npc[i] = PC;
+        }
+    }
+
+    if (ls->active > 0) ls->pc = LockstepVote(ls, npc);
+}
+
+/* DROP THE LANES WITH A PENDING INTERRUPT, THE SCALAR PATH WILL SERVE IT */
+static void LockstepPollIrq(FemtoLockstep_t *ls)
+{
+    for (int i = 0; i < ls->lanes; i++)
+    {
+        FemtoEmu_t *emu = ls->lane[i];
+
+        if (ls->mask[i] && CHK_IREQ(emu) && CHK_IRQ_ENABLE(emu))
+        {
+            LaneLoad(ls, i, ls->pc);
+            LaneDrop(ls, i, false);
+        }
+    }
+}
+
+static void LockstepDropAll(FemtoLockstep_t *ls)
+{
+    for (int i = 0; i < ls->lanes; i++)
+    {
+        if (!ls->mask[i]) continue;
+        LaneLoad(ls, i, ls->pc);
+        LaneDrop(ls, i, false);
+    }
+}
+/*** END OF HELPING FUNCTIONS ***/
+
+
+FemtoLockstep_t * LockstepInit(const char *rom_file, int lanes, bool verbose)
+{
+    FemtoLockstep_t *ls   = NULL;
+    FILE            *rom  = NULL;
+    long             size = 0L;
+
+
+    if (lanes < 1 || lanes > LOCKSTEP_MAX)
+    {
+        printf("ERROR (LockstepInit): INVALID NUMBER OF LANES %d (1 - %d) !!!\n", lanes, LOCKSTEP_MAX);
+        exit(-1);
+    }
+
+    /* THE SIZE OF THE ROM BOUND THE CODE THAT CAN BE FETCHED ONCE FOR ALL LANES */
+    rom = fopen(rom_file, "rb");
+    if (rom == NULL)
+    {
+        printf("ERROR (LockstepInit): CAN'T OPEN FILE \"%s\" !!!\n", rom_file);
+        exit(-1);
+    }
+    fseek(rom, 0L, SEEK_END);
+    size = ftell(rom);
+    fclose(rom);
+
+
+    /* LOCKSTEP STATE ALLOCATION */
+    ls = calloc(1, sizeof(FemtoLockstep_t));
+    if (ls == NULL)
+    {
+        printf("ERROR (LockstepInit): CAN'T ALLOCATE LOCKSTEP STATE !!!\n");
+        exit(-1);
+    }
+    ls->lanes    = lanes;
+    ls->padded   = (lanes + LOCKSTEP_ALIGN - 1) & ~(LOCKSTEP_ALIGN - 1);
+    ls->active   = lanes;
+    ls->rom_size = (size > 0xFFF) ? 0xFFF : (uint16_t)size;
+
+    for (int k = 0; k < 4; k++)
+    {
+        ls->r[k] = aligned_alloc(LOCKSTEP_ALIGN, ls->padded);
+    }
+    ls->sp      = aligned_alloc(LOCKSTEP_ALIGN, ls->padded);
+    ls->flags   = aligned_alloc(LOCKSTEP_ALIGN, ls->padded);
+    ls->mask    = aligned_alloc(LOCKSTEP_ALIGN, ls->padded);
+    ls->dropped = calloc(lanes, sizeof(bool));
+    ls->lane    = calloc(lanes, sizeof(FemtoEmu_t *));
+    if (ls->r[0] == NULL || ls->r[1] == NULL || ls->r[2] == NULL || ls->r[3] == NULL || ls->sp == NULL ||
+        ls->flags == NULL || ls->mask == NULL || ls->dropped == NULL || ls->lane == NULL)
+    {
+        printf("ERROR (LockstepInit): CAN'T ALLOCATE LANES !!!\n");
+        exit(-1);
+    }
+
+
+    /* ALL LANES START FROM THE SAME FRESHLY LOADED MACHINE */
+    ls->lane[0] = EmuInit(rom_file, verbose);
+    for (int i = 1; i < lanes; i++)
+    {
+        ls->lane[i] = EmuClone(ls->lane[0]);
+        ls->lane[i]->id = (uint16_t)i;
+    }
+
+    for (int k = 0; k < 4; k++)
+    {
+        memset(ls->r[k], 0, ls->padded);
+    }
+    memset(ls->sp, 0, ls->padded);
+    memset(ls->flags, ls->lane[0]->flags, ls->padded);
+    memset(ls->mask, 0x00, ls->padded);
+    memset(ls->mask, 0xFF, lanes);
+    ls->pc = ls->lane[0]->pc;
+
+#ifdef LOCKSTEP_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+    {
+        Kernels = &KernelsAvx2;
+    }
+    else if (__builtin_cpu_supports("popcnt"))
+    {
+        Kernels = &KernelsSse2;
+    }
+#endif
+    if (verbose == true) printf("LOCKSTEP: %d LANES, %s KERNELS\n", lanes, Kernels->name);
+
+    return ls;
+}
+
+
+void LockstepRun(FemtoLockstep_t *ls, bool verbose)
+{
+    const struct timespec full = { 0, 100000 };   /* 100us */
+    uint16_t *npc   = NULL;
+    uint8_t  *take  = NULL;
+    uint8_t  *imm   = NULL;   /* IMMEDIATE OPERAND BROADCAST TO THE LANES */
+    uint32_t  steps = 0;
+
+
+    npc  = malloc(ls->lanes * sizeof(uint16_t));
+    take = aligned_alloc(LOCKSTEP_ALIGN, ls->padded);
+    imm  = aligned_alloc(LOCKSTEP_ALIGN, ls->padded);
+    if (npc == NULL || take == NULL || imm == NULL)
+    {
+        printf("ERROR (LockstepRun): CAN'T ALLOCATE SCRATCH BUFFERS !!!\n");
+        exit(-1);
+    }
+
+    /*** LOCKSTEP LOOP ***/
+    printf("LOCKSTEP: STARTING EMULATION OF %d LANES\n", ls->lanes);
+    while (ls->active > 0)
+    {
+        /* CODE OUTSIDE THE ROM MAY DIFFER BETWEEN LANES, IT CAN'T BE FETCHED ONCE */
+        if ((ls->pc + 3) > ls->rom_size)
+        {
+            LockstepDropAll(ls);
+            break;
+        }
+
+        /* FETCH & DECODE ONCE FOR ALL LANES */
+        uint8_t  *ram  = ls->lane[0]->ram;
+        uint8_t   f0   = ram[ls->pc];
+        uint8_t   f1   = ram[ls->pc + 1];
+        uint8_t   f2   = ram[ls->pc + 2];
+        uint8_t   inst = f0 & 0x7F;
+        bool      adrm = (f0 & 0x80) >> 7;
+        uint8_t   dreg = (f1 >> 6) & 0x03;
+        uint8_t   sreg = (f1 >> 4) & 0x03;
+        uint16_t  addr = ((f1 & 0x0F) << 8) | f2;
+        uint8_t   bits = 0;
+        bool      set  = true;
+        int       taken;
+
+        if (verbose == true) printf("LOCKSTEP [0x%03X] INST 0x%02X, %d ACTIVE LANES\n", ls->pc, inst, ls->active);
+
+        switch (inst)
+        {
+            case LDR:
+                if (adrm == ADRM_IMM) Kernels->ldi(ls->r[dreg], f2, ls->mask, ls->padded);
+                else                  Kernels->ldr(ls->r[dreg], ls->r[sreg], ls->mask, ls->padded);
+                ls->pc += 3;
+                break;
+
+            case ADD:
+                if (adrm == ADRM_IMM) Kernels->ldi(imm, f2, ls->mask, ls->padded);
+                Kernels->add(ls->r[dreg], (adrm == ADRM_IMM) ? imm : ls->r[sreg], ls->flags, ls->mask, ls->padded);
+                ls->pc += 3;
+                break;
+
+            case SUB:
+            case CMP:
+                if (adrm == ADRM_IMM) Kernels->ldi(imm, f2, ls->mask, ls->padded);
+                Kernels->sub(ls->r[dreg], (adrm == ADRM_IMM) ? imm : ls->r[sreg], ls->flags, ls->mask, ls->padded, inst == SUB);
+                ls->pc += 3;
+                break;
+
+            case JMP:
+                ls->pc = addr;
+                break;
+
+            /* CONDITIONAL JUMPS: (FLAGS & bits) != 0 MUST BE EQUAL TO set */
+            case JZ:  bits = 0x1; set = true;  goto jcc;
+            case JNZ: bits = 0x1; set = false; goto jcc;
+            case JN:  bits = 0x4; set = true;  goto jcc;
+            case JNN: bits = 0x4; set = false; goto jcc;
+            case JC:  bits = 0x2; set = true;  goto jcc;
+            case JNC: bits = 0x2; set = false; goto jcc;
+            case JBE: bits = 0x3; set = true;  goto jcc;
+            case JA:  bits = 0x3; set = false; goto jcc;
+            jcc:
+                taken = Kernels->jcc(ls->flags, bits, set, ls->mask, take, ls->padded);
+
+                /* DIVERGENT BRANCH: THE MINORITY SIDE LEAVE THE LOCKSTEP */
+                if (taken != 0 && taken != ls->active)
+                {
+                    bool     keep_taken = (taken * 2 >= ls->active);
+                    uint16_t other      = keep_taken ? (uint16_t)(ls->pc + 3) : addr;
+
+                    for (int i = 0; i < ls->lanes; i++)
+                    {
+                        if (ls->mask[i] && ((take[i] != 0) != keep_taken))
+                        {
+                            LaneLoad(ls, i, other);
+                            LaneDrop(ls, i, false);
+                        }
+                    }
+                    taken = keep_taken ? ls->active : 0;
+                }
+                ls->pc = (taken != 0) ? addr : (uint16_t)(ls->pc + 3);
+                break;
+
+            default:
+                LockstepScalarStep(ls, npc, verbose);
+                continue;
+        }
+
+        ls->vec_inst++;
+        if ((++steps % LOCKSTEP_IRQ_POLL) == 0) LockstepPollIrq(ls);
+    }
+
+
+    /* THE LANES DON'T RUN EmuStep: HAND OVER THE LAST BUFFERED OUT OF A LANE THAT HALTED IN LOCKSTEP */
+    while (!IOFlush()) nanosleep(&full, NULL);
+
+
+    /*** LANES THAT DIVERGED FINISH ON THE SCALAR PATH ***/
+    for (int i = 0; i < ls->lanes; i++)
+    {
+        FemtoEmu_t *emu = ls->lane[i];
+
+        if (!ls->dropped[i]) continue;
+
+        IOBind(emu);
+        while (!emu->halt)
+        {
+            EmuStep(emu, verbose);
+            emu->wait = false;
+            ls->scal_inst++;
+        }
+        ls->dropped[i] = false;
+    }
+
+    printf("LOCKSTEP: %llu VECTOR, %llu LANE & %llu SCALAR INSTRUCTIONS\n",
+           (unsigned long long)ls->vec_inst, (unsigned long long)ls->lane_inst, (unsigned long long)ls->scal_inst);
+
+    free(imm);
+    free(take);
+    free(npc);
+}
+
+
+void LockstepQuit(FemtoLockstep_t *ls)
+{
+    printf("LOCKSTEP: HALTING EMULATION\n");
+    for (int i = 0; i < ls->lanes; i++)
+    {
+        free(ls->lane[i]->ram);
+        free(ls->lane[i]);
+    }
+    for (int k = 0; k < 4; k++)
+    {
+        free(ls->r[k]);
+    }
+    free(ls->sp);
+    free(ls->flags);
+    free(ls->mask);
+    free(ls->dropped);
+    free(ls->lane);
+    free(ls);
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+#ifndef LOCKSTEP_H_
+#define LOCKSTEP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../femto.h"
+
+#define LOCKSTEP_ALIGN  32      /* LANE ARRAYS ARE PADDED & ALIGNED FOR 32 LANES (ONE AVX2 REGISTER) */
+#define LOCKSTEP_MAX    0xFFFF  /* MAXIMUM NUMBER OF LANES (MACHINE INDEX IS 16BITS) */
+
+
+/* N MACHINES RUNNING THE SAME ROM, REGISTERS & FLAGS STORED AS STRUCTURE OF ARRAYS.
+ * ALL ACTIVE LANES SHARE THE SAME PC; A LANE THAT DIVERGE IS DROPPED TO THE SCALAR PATH. */
+typedef struct FemtoLockstep
+{
+    int          lanes;     /* NUMBER OF LANES (MACHINES) */
+    int          padded;    /* NUMBER OF LANES ROUNDED UP TO LOCKSTEP_ALIGN */
+    int          active;    /* NUMBER OF LANES STILL IN LOCKSTEP */
+    uint16_t     pc;        /* SHARED PROGRAM COUNTER */
+    uint16_t     rom_size;  /* CODE BELOW THIS ADDRESS IS IDENTICAL IN ALL LANES */
+    uint8_t     *r[4];      /* GP REGISTERS, ONE ARRAY PER REGISTER */
+    uint8_t     *sp;        /* STACK POINTERS */
+    uint8_t     *flags;     /* FLAGS REGISTERS */
+    uint8_t     *mask;      /* 0xFF IF THE LANE IS STILL IN LOCKSTEP, 0x00 OTHERWISE */
+    bool        *dropped;   /* LANE LEAVE THE LOCKSTEP BEFORE HALTING, MUST FINISH ON THE SCALAR PATH */
+    FemtoEmu_t **lane;      /* BACKING MACHINE OF EACH LANE (RAM, SCALAR EXECUTION) */
+    uint64_t     vec_inst;  /* INSTRUCTIONS EXECUTED WITH THE VECTOR KERNELS (PER GROUP) */
+    uint64_t     lane_inst; /* INSTRUCTIONS EXECUTED LANE BY LANE WHILE IN LOCKSTEP */
+    uint64_t     scal_inst; /* INSTRUCTIONS EXECUTED BY DROPPED LANES */
+} FemtoLockstep_t;
+
+
+FemtoLockstep_t * LockstepInit(const char *rom_file, int lanes, bool verbose);
+void              LockstepRun(FemtoLockstep_t *ls, bool verbose);
+void              LockstepQuit(FemtoLockstep_t *ls);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,167 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "cpu.h"
+#include "int.h"
+#include "smp.h"
+#include "../common.h"
+#include "../io/io.h"
+
+
+/* THE IO CALLBACKS ARE GLOBAL, SO THERE IS ONLY ONE SMP MACHINE AT A TIME */
+static FemtoSmp_t *Smp = NULL;
+
+
+/*** IO CALLBACKS ***/
+static INPFUNC(SmpCoreId)
+{
+    return (uint8_t)IOMachine()->id;
+}
+
+static INPFUNC(SmpCoreCount)
+{
+    return (uint8_t)Smp->cores;
+}
+
+static OUTFUNC(SmpIpi, data)
+{
+    if (data < Smp->cores) SmpIrq(Smp, data);
+}
+/*** END OF IO CALLBACKS ***/
+
+
+static void * SmpThread(void *arg)
+{
+    FemtoEmu_t *emu = arg;
+
+    IOBind(emu);
+    while (!HALT)
+    {
+        EmuStep(emu, Smp->verbose);
+        WAIT = false;
+    }
+
+    return NULL;
+}
+
+
+FemtoSmp_t * SmpInit(const char *rom_file, int cores, bool verbose)
+{
+    FemtoSmp_t *smp = NULL;
+
+
+    if (cores < 1 || cores > SMP_MAX_CORES)
+    {
+        printf("ERROR (SmpInit): INVALID NUMBER OF CORES %d (1 - %d) !!!\n", cores, SMP_MAX_CORES);
+        exit(-1);
+    }
+
+    smp = calloc(1, sizeof(FemtoSmp_t));
+    if (smp == NULL)
+    {
+        printf("ERROR (SmpInit): CAN'T ALLOCATE SMP STATE !!!\n");
+        exit(-1);
+    }
+    smp->cores   = cores;
+    smp->verbose = verbose;
+
+
+    /* CORE 0 LOAD THE ROM, THE OTHERS ARE COPIES OF ITS STATE SHARING ITS RAM */
+    smp->core[0] = EmuInit(rom_file, verbose);
+    smp->ram     = smp->core[0]->ram;
+    for (int i = 1; i < cores; i++)
+    {
+        smp->core[i] = malloc(sizeof(FemtoEmu_t));
+        if (smp->core[i] == NULL)
+        {
+            printf("ERROR (SmpInit): CAN'T ALLOCATE CORE %d !!!\n", i);
+            exit(-1);
+        }
+        *smp->core[i] = *smp->core[0];
+    }
+    for (int i = 0; i < cores; i++)
+    {
+        smp->core[i]->id     = (uint16_t)i;
+        smp->core[i]->stack  = (uint16_t)(STACK_BASE - (i * 0x100));
+        smp->core[i]->shared = true;
+    }
+
+    RegisterInputFunc(SmpCoreId, SMP_ID_PORT);
+    RegisterInputFunc(SmpCoreCount, SMP_CORES_PORT);
+    RegisterOutputFunc(SmpIpi, SMP_IPI_PORT);
+    Smp = smp;
+
+    if (verbose == true) printf("SMP: %d CORES SHARING THE RAM\n", cores);
+    return smp;
+}
+
+
+/* RAISE THE IRQ LINE OF A CORE, CAN BE CALLED FROM ANY HOST THREAD */
+void SmpIrq(FemtoSmp_t *smp, int core)
+{
+    IREQ_LINE(smp->core[core], SMP_IPI_LINE)
+}
+
+
+void SmpRun(FemtoSmp_t *smp)
+{
+    printf("SMP: STARTING EMULATION ON %d CORES\n", smp->cores);
+    for (int i = 0; i < smp->cores; i++)
+    {
+        if (pthread_create(&smp->thread[i], NULL, SmpThread, smp->core[i]) != 0)
+        {
+            printf("ERROR (SmpRun): CAN'T CREATE THREAD FOR CORE %d !!!\n", i);
+            exit(-1);
+        }
+    }
+
+    /* THE MACHINE STOP WHEN ALL CORES ARE HALTED */
+    for (int i = 0; i < smp->cores; i++)
+    {
+        pthread_join(smp->thread[i], NULL);
+    }
+
+    for (int i = 0; i < smp->cores; i++)
+    {
+        printf("SMP: CORE %d EXECUTED %llu CYCLES\n", i, (unsigned long long)smp->core[i]->cycles);
+    }
+}
+
+
+void SmpQuit(FemtoSmp_t *smp)
+{
+    printf("SMP: HALTING EMULATION\n");
+    for (int i = 0; i < smp->cores; i++)
+    {
+        free(smp->core[i]);
+    }
+    free(smp->ram);
+    if (Smp == smp) Smp = NULL;
+    free(smp);
+}
\ No newline at end of file
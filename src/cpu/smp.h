@@ -0,0 +1,71 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+/* SMP MACHINE:
+ * - N CORES (1 - SMP_MAX_CORES) SHARING THE 4KBs RAM, EACH ONE RUN ON ITS OWN HOST THREAD
+ * - ALL CORES START AT 0x000, GUEST CODE READ SMP_ID_PORT TO KNOW ON WHICH CORE IT RUNS
+ * - CORE n STACK IS AT STACK_BASE - (n * 0x100), SO 8 CORES USE 0x800 - 0xFFF
+ * - OUT n TO SMP_IPI_PORT RAISE THE IRQ OF CORE n
+ * - MEMORY ORDERING: EVERY GUEST ACCESS TO THE RAM (FETCH, LDM, STR, STI, STACK, VECTORS, BMOV &
+ *   FILL BYTE BY BYTE) IS A RELAXED HOST ATOMIC (RAM_LOAD / RAM_STORE), SO IT IS NEVER TORN, MERGED
+ *   OR ELIDED, BUT TWO ACCESSES OF A CORE MAY BE SEEN IN ANY ORDER BY THE OTHERS
+ * - CAS IS THE ONLY BARRIER: ACQUIRE (ITS LOAD) & RELEASE (ITS STORE); THE ACCESSES BEFORE A CAS ARE
+ *   SEEN BY A CORE WHICH CAS READ ITS RESULT. A LOCK IS TAKEN WITH CAS AND MUST ALSO BE RELEASED
+ *   WITH CAS (R0 = LOCKED VALUE, REG = FREE VALUE), A PLAIN STR DOES NOT PUBLISH THE CRITICAL SECTION
+ */
+
+#ifndef SMP_H_
+#define SMP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "../femto.h"
+
+#define SMP_MAX_CORES   8
+#define SMP_ID_PORT     0xFE    /* IN  : ID OF THE CORE EXECUTING THE IN */
+#define SMP_CORES_PORT  0xFD    /* IN  : NUMBER OF CORES */
+#define SMP_IPI_PORT    0xFD    /* OUT : RAISE THE IRQ OF THE CORE WHICH ID IS WRITTEN */
+#define SMP_IPI_LINE    3       /* LINE OF THE INTERRUPT CONTROLLER RAISED BY AN IPI */
+
+
+typedef struct FemtoSmp
+{
+    FemtoEmu_t *core[SMP_MAX_CORES];
+    pthread_t   thread[SMP_MAX_CORES];
+    int         cores;
+    uint8_t    *ram;        /* SHARED BY ALL CORES */
+    bool        verbose;
+} FemtoSmp_t;
+
+
+FemtoSmp_t * SmpInit(const char *rom_file, int cores, bool verbose);
+void         SmpIrq(FemtoSmp_t *smp, int core);
+void         SmpRun(FemtoSmp_t *smp);
+void         SmpQuit(FemtoSmp_t *smp);
+
+#endif
\ No newline at end of file
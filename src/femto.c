@@ -29,10 +29,14 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
+#include <time.h>
 #include "cpu/cpu.h"
 #include "io/io.h"
 #include "common.h"
 #include "cpu/int.h"
+#include "cpu/event.h"
+#include "cpu/idle.h"
 
 
 /*** HELPING FUNCTIONS ***/
@@ -86,7 +90,27 @@ void ResetEmuState(FemtoEmu_t *emu)
     emu->dreg  = 0;         /* DESTINATION REGISTER */
     emu->sreg  = 0;         /* SOURCE REGISTER */
     emu->temp  = 0;
-    emu->ireq  = false;     /* INTERRUPT REQUEST (HARDWARE) */
+    emu->ireq  = 0;         /* NO PENDING INTERRUPT LINE */
+    emu->imask = 0xFF;      /* ALL INTERRUPT LINES ENABLED */
+    emu->iline = 0;
+    emu->isel  = 0;
+    for (int i = 0; i < IRQ_LINES; i++)
+    {
+        emu->ivec[i] = IRQ_VEC_RAM; /* ALL LINES USE THE IRQ VECTOR */
+    }
+    emu->id    = 0;         /* MACHINE INDEX */
+    emu->cycles = 0;        /* GUEST CYCLES */
+    emu->wait  = false;     /* CPU IS BLOCKED ON AN IO PORT */
+    emu->stack = STACK_BASE; /* STACK BASE ADDRESS */
+    emu->shared = false;    /* RAM OF ITS OWN */
+    emu->cov   = NULL;      /* NO EDGE COVERAGE */
+    emu->cov_prev = 0;
+    emu->cov_lines = NULL;
+    emu->fault = FAULT_NONE; /* NO GUEST FAULT */
+    emu->dirty = 0;         /* NO DIRTY PAGE */
+    emu->next_event = EVENT_NONE; /* NO PENDING EVENT */
+    emu->events = NULL;
+    emu->idle  = NULL;      /* NO IDLE-LOOP DETECTION */
 }
 /*** END OF HELPING FUNCTIONS ***/
 
@@ -133,19 +157,94 @@ FemtoEmu_t * EmuInit(const char *rom_file, bool verbose)
 
     /* IO INIT */
     IOInit(verbose);
+    IntInit();
+
+    return temp;
+}
+
+
+FemtoEmu_t * EmuClone(const FemtoEmu_t *emu)
+{
+    FemtoEmu_t *temp = NULL;
+
+
+    /* EMULATION STATE ALLOCATION & COPY */
+    temp = malloc(sizeof(FemtoEmu_t));
+    if (temp == NULL)
+    {
+        printf("ERROR (EmuClone): CAN'T ALLOCATE EMULATION STATE!!!\n");
+        exit(-1);
+    }
+    *temp = *emu;
+
+
+    /* RAM ALLOCATION & COPY, THE CLONE MUST NOT SHARE THE RAM OF ITS PARENT */
+    temp->ram = malloc(4 * 1024 * sizeof(uint8_t));
+    if (temp->ram == NULL)
+    {
+        printf("ERROR (EmuClone): CAN'T ALLOCATE VIRTUAL RAM !!!\n");
+        free(temp);
+        exit(-1);
+    }
+    memcpy(temp->ram, emu->ram, 4 * 1024 * sizeof(uint8_t));
+
+    temp->shared     = false;
+
+    /* THE EVENTS BELONG TO THE DEVICES OF THE PARENT */
+    temp->events     = NULL;
+    temp->next_event = EVENT_NONE;
+    temp->idle       = NULL;
 
     return temp;
 }
 
 
+void EmuStep(FemtoEmu_t *emu, bool verbose)
+{
+    const struct timespec full = { 0, 100000 };   /* 100us */
+
+    CpuExecInst(emu, verbose);
+
+    /* DEVICES EVENTS, ONLY WHEN THE EARLIEST DEADLINE IS REACHED, AFTER THE BUFFERED OUT */
+    if (emu->cycles >= emu->next_event)
+    {
+        bool flushed = IOFlush();
+
+        EventRun(emu);
+
+        /* THE BULK HANDLER IS FULL, THE BYTES LEFT ARE TRIED AGAIN IO_BULK_CYCLES LATER */
+        if (!flushed) IOFlushDeadline(emu);
+    }
+
+    /* THE LAST BUFFERED OUT OF A HALTED MACHINE, THE BULK HANDLERS MAKE ROOM FROM THEIR HOST THREAD */
+    if (emu->halt)
+    {
+        while (!IOFlush()) nanosleep(&full, NULL);
+    }
+
+    /* AN ACCEPTED INTERRUPT ALSO ABORT A BLOCKED IN/OUT, IT WILL BE RETRIED ON RETURN */
+    if (CHK_IREQ(emu) && CHK_IRQ_ENABLE(emu))
+    {
+        emu->wait = false;
+        IntReq(emu);
+    }
+}
+
+
 void EmuLoop(FemtoEmu_t *emu, bool verbose)
 {
     /*** EMULATION LOOP ***/
     printf("FEMTO: STARTING EMULATION\n");
+    IOBind(emu);
     while (!emu->halt)
     {
-        CpuExecInst(emu, verbose);
-        if (CHK_IREQ(emu)) IntReq(emu);
+        uint16_t pc = emu->pc;
+
+        EmuStep(emu, verbose);
+        if (emu->idle != NULL) IdleCheck(emu, pc);
+
+        /* NOBODY ELSE CAN UNBLOCK A LONE MACHINE, JUST RETRY THE IN/OUT */
+        emu->wait = false;
     }
 }
 
@@ -153,6 +252,8 @@ void EmuLoop(FemtoEmu_t *emu, bool verbose)
 void EmuQuit(FemtoEmu_t *emu)
 {
     printf("FEMTO: HALTING EMULATION\n");
+    EventQuit(emu);
+    IdleQuit(emu);
     free(emu->ram);
     free(emu);
 }
\ No newline at end of file
@@ -20,6 +20,7 @@
  * - 4KBs RAM
  * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
  * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - ARITHMETIC & LOGIC INSTRUCTIONS (ADD, SUB, CMP, ...) UPDATE N, C & Z ONLY, I IS ONLY CHANGED BY SEI & SDI
  * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
  * - MIII IIII   RRRR xxxx   DDDD DDDD
  * - MIII IIII   RRRR AAAA   AAAA AAAA
@@ -48,12 +49,31 @@ typedef struct FemtoEmu
     uint8_t   dreg;    /* DESTINATION REGISTER */
     uint8_t   sreg;    /* SOURCE REGISTER */
     int       temp;
-    bool      ireq;    /* INTERRUPT REQUEST (HARDWARE) */ 
+    uint8_t   ireq;    /* PENDING INTERRUPT LINES (BIT n : LINE n), SET ATOMICALLY BY ANY HOST THREAD */
+    uint8_t   imask;   /* ENABLED INTERRUPT LINES */
+    uint8_t   iline;   /* LAST INTERRUPT LINE SERVED */
+    uint8_t   isel;    /* LINE SELECTED FOR THE NEXT VECTOR WRITE */
+    uint16_t  ivec[8]; /* VECTOR OF EACH LINE (IRQ_VEC_RAM : ADDRESS STORED AT IREQ_VEC) */
+    uint16_t  id;      /* MACHINE INDEX (LOCKSTEP LANE, SCHEDULER TASK, ...) */
+    uint64_t  cycles;  /* GUEST CYCLES EXECUTED SINCE RESET */
+    bool      wait;    /* CPU IS BLOCKED ON AN IO PORT, THE IN/OUT WILL BE RETRIED */
+    uint16_t  stack;   /* STACK BASE ADDRESS (EACH CORE OF A SMP MACHINE HAS ITS OWN) */
+    bool      shared;  /* RAM SHARED WITH OTHER CORES (SMP), NO PLAIN memmove / memset ON IT */
+    uint8_t  *cov;     /* EDGE COVERAGE BITMAP, COV_SIZE BYTES (NULL : NO COVERAGE) */
+    uint16_t  cov_prev;/* HASH OF THE PREVIOUS BLOCK FOR THE EDGE COVERAGE */
+    uint64_t *cov_lines;/* 1 BIT PER COV_LINE BYTES OF cov WRITTEN (NULL : NOT TRACKED) */
+    uint8_t   fault;   /* FIRST GUEST FAULT SINCE RESET (FAULT_xxx) */
+    uint16_t  dirty;   /* RAM PAGES WRITTEN SINCE RESET (1 BIT PER 0x100 BYTES) */
+    uint64_t  next_event;      /* CYCLE OF THE EARLIEST PENDING EVENT (EVENT_NONE : NO EVENT) */
+    struct FemtoEvents *events;/* PENDING EVENTS OF THE DEVICES (NULL : NONE YET) */
+    struct FemtoIdle   *idle;  /* IDLE-LOOP DETECTOR (NULL : POLLING LOOPS ARE EXECUTED) */
 } FemtoEmu_t;
 
 
 FemtoEmu_t * EmuInit(const char *rom_file, bool verbose);
+FemtoEmu_t * EmuClone(const FemtoEmu_t *emu);
 void         EmuQuit(FemtoEmu_t *emu);
+void         EmuStep(FemtoEmu_t *emu, bool verbose);
 void         EmuLoop(FemtoEmu_t *emu, bool verbose);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,237 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/shm.h>
+#include <sys/wait.h>
+#include "forksrv.h"
+#include "../common.h"
+#include "../cpu/cpu.h"
+#include "../io/io.h"
+
+
+/* TEST CASE OF THE CHILD */
+static uint8_t  Case[FORKSRV_MAX_CASE];
+static uint32_t CaseLen = 0;
+static uint32_t CasePos = 0;
+
+
+/*** IO CALLBACK OF THE FUZZED PORTS ***/
+static INPFUNC(ForkSrvIn)
+{
+    if (CasePos < CaseLen) return Case[CasePos++];
+
+    /* END OF THE TEST CASE, END OF THE RUN */
+    IOMachine()->halt = true;
+    return 0xFF;
+}
+/*** END OF IO CALLBACK ***/
+
+
+/*** HELPING FUNCTIONS ***/
+static void ForkSrvLoadCase(ForkSrvConfig_t *cfg)
+{
+    int     fd = 0;
+    ssize_t n  = 0;
+
+    if (cfg->input != NULL)
+    {
+        fd = open(cfg->input, O_RDONLY);
+        if (fd < 0)
+        {
+            printf("ERROR (ForkSrvLoadCase): CAN'T OPEN FILE \"%s\" !!!\n", cfg->input);
+            exit(-1);
+        }
+    }
+
+    CaseLen = 0;
+    CasePos = 0;
+    while (CaseLen < FORKSRV_MAX_CASE && (n = read(fd, Case + CaseLen, FORKSRV_MAX_CASE - CaseLen)) > 0)
+    {
+        CaseLen += (uint32_t)n;
+    }
+
+    if (fd != 0) close(fd);
+}
+
+/* RUN ONE TEST CASE FROM THE SNAPSHOT, RETURN TRUE ON CRASH */
+static bool ForkSrvRunCase(FemtoEmu_t *emu, ForkSrvConfig_t *cfg, bool verbose)
+{
+    uint64_t end = CYCLES + cfg->limit;
+
+    ForkSrvLoadCase(cfg);
+    emu->cov_prev = 0;
+
+    while (!HALT && FAULT == FAULT_NONE && CYCLES < end)
+    {
+        EmuStep(emu, verbose);
+        WAIT = false;
+    }
+
+    return (FAULT != FAULT_NONE);
+}
+
+static uint8_t * ForkSrvCoverage(void)
+{
+    char    *id  = getenv(FORKSRV_SHM_ENV);
+    uint8_t *map = NULL;
+
+    if (id == NULL)
+    {
+        map = calloc(COV_SIZE, sizeof(uint8_t));
+    }
+    else
+    {
+        map = shmat(atoi(id), NULL, 0);
+        if (map == (void *)-1) map = NULL;
+    }
+
+    if (map == NULL)
+    {
+        printf("ERROR (ForkSrvCoverage): CAN'T MAP THE COVERAGE BITMAP !!!\n");
+        exit(-1);
+    }
+    return map;
+}
+/*** END OF HELPING FUNCTIONS ***/
+
+
+/* TRUE IF THE NEXT INSTRUCTION IS THE SNAPSHOT POINT */
+bool ForkSrvAtSnapshot(FemtoEmu_t *emu, ForkSrvConfig_t *cfg)
+{
+    uint8_t f0 = RAM[PC % 0xFFF];
+    uint8_t f1 = RAM[(PC + 1) % 0xFFF];
+    uint8_t f2 = RAM[(PC + 2) % 0xFFF];
+
+    if (cfg->fork_pc >= 0) return (PC == cfg->fork_pc);
+    if ((f0 & 0x7F) != IN) return false;
+
+    return cfg->port[(((f0 & 0x80) >> 7) == ADRM_IMM) ? f2 : R[(f1 >> 4) & 0x03]];
+}
+
+
+/* RUN THE MACHINE UNTIL THE SNAPSHOT POINT, FALSE IF IT HALTED BEFORE */
+bool ForkSrvWarmUp(FemtoEmu_t *emu, ForkSrvConfig_t *cfg, bool verbose)
+{
+    IOBind(emu);
+    while (!HALT && !ForkSrvAtSnapshot(emu, cfg))
+    {
+        EmuStep(emu, verbose);
+        WAIT = false;
+    }
+    if (HALT)
+    {
+        printf("ERROR (ForkSrvWarmUp): MACHINE HALTED BEFORE THE SNAPSHOT POINT !!!\n");
+        return false;
+    }
+
+    if (verbose == true) printf("FORKSRV: SNAPSHOT AT 0x%03X AFTER %llu CYCLES\n", PC, (unsigned long long)CYCLES);
+    return true;
+}
+
+
+/* PARSE A COMMA SEPARATED LIST OF PORTS (EX: "0x20,0x21") */
+bool ForkSrvParsePorts(ForkSrvConfig_t *cfg, const char *list)
+{
+    char *end = NULL;
+
+    while (*list != '\0')
+    {
+        long port = strtol(list, &end, 0);
+
+        if (end == list || port < 0 || port > 0xFF) return false;
+        cfg->port[port] = true;
+        list = (*end == ',') ? end + 1 : end;
+    }
+    return true;
+}
+
+
+int ForkServer(FemtoEmu_t *emu, ForkSrvConfig_t *cfg, bool verbose)
+{
+    uint32_t msg    = 0;
+    int      status = 0;
+    pid_t    pid    = 0;
+
+
+    /*** WARM UP: RUN ONCE UNTIL THE SNAPSHOT POINT ***/
+    if (!ForkSrvWarmUp(emu, cfg, verbose)) return -1;
+
+    for (int p = 0; p < 256; p++)
+    {
+        if (cfg->port[p]) RegisterInputFunc(ForkSrvIn, (uint8_t)p);
+    }
+    emu->cov = ForkSrvCoverage();
+
+
+    /*** NO FUZZER ON THE OTHER SIDE: RUN A SINGLE CASE ***/
+    if (fcntl(FORKSRV_ST_FD, F_GETFD) == -1 || write(FORKSRV_ST_FD, &msg, 4) != 4)
+    {
+        int edges = 0;
+
+        if (ForkSrvRunCase(emu, cfg, verbose))
+        {
+            printf("FORKSRV: CRASH, FAULT %d (OPCODE 0x%02X AT 0x%03X)\n", FAULT, INST, (PC - 3) & 0xFFF);
+        }
+        for (int i = 0; i < COV_SIZE; i++)
+        {
+            edges += (emu->cov[i] != 0);
+        }
+        printf("FORKSRV: %u BYTES READ, %llu CYCLES, %d EDGES\n", CasePos, (unsigned long long)CYCLES, edges);
+        return 0;
+    }
+
+
+    /*** FORK SERVER LOOP: ONE CHILD PER TEST CASE, EACH ONE START FROM THE SNAPSHOT ***/
+    while (read(FORKSRV_CTL_FD, &msg, 4) == 4)
+    {
+        pid = fork();
+        if (pid < 0)
+        {
+            printf("ERROR (ForkServer): CAN'T FORK !!!\n");
+            return -1;
+        }
+
+        if (pid == 0)
+        {
+            close(FORKSRV_CTL_FD);
+            close(FORKSRV_ST_FD);
+            if (ForkSrvRunCase(emu, cfg, verbose)) abort();
+            _exit(0);
+        }
+
+        if (write(FORKSRV_ST_FD, &pid, 4) != 4) return -1;
+        if (waitpid(pid, &status, 0) < 0)       return -1;
+        if (write(FORKSRV_ST_FD, &status, 4) != 4) return -1;
+    }
+
+    return 0;
+}
\ No newline at end of file
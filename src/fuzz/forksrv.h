@@ -0,0 +1,67 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+/* FORK SERVER (AFL PROTOCOL):
+ * - THE MACHINE RUN UNTIL THE SNAPSHOT POINT: fork_pc, OR BY DEFAULT THE FIRST IN ON A FUZZED PORT
+ * - THEN, FOR EACH 4 BYTES READ ON FORKSRV_CTL_FD, A CHILD IS FORKED FROM THIS WARM STATE; ITS PID
+ *   AND THEN ITS wait() STATUS ARE WRITTEN (4 BYTES EACH) ON FORKSRV_ST_FD
+ * - THE CHILD READ THE TEST CASE (STDIN OR input FILE), THE FUZZED IN PORTS RETURN ITS BYTES IN ORDER
+ *   AND THE MACHINE HALT AT THE END OF THE CASE
+ * - EDGE COVERAGE GOES TO THE SYSV SHARED MEMORY GIVEN BY FORKSRV_SHM_ENV (COV_SIZE BYTES)
+ * - A GUEST FAULT (INVALID OPCODE, ILLEGAL ADDRESSING MODE, STACK WRAP) IS A CRASH, THE CHILD abort()
+ * - WITHOUT FORKSRV_ST_FD OPEN, A SINGLE CASE IS RUN WITHOUT FORKING
+ */
+
+#ifndef FORKSRV_H_
+#define FORKSRV_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../femto.h"
+
+#define FORKSRV_CTL_FD    198
+#define FORKSRV_ST_FD     199
+#define FORKSRV_SHM_ENV   "__AFL_SHM_ID"
+#define FORKSRV_LIMIT     1000000     /* DEFAULT CYCLES LIMIT OF A TEST CASE */
+#define FORKSRV_MAX_CASE  (64 * 1024) /* TEST CASE BYTES BEYOND THIS ARE IGNORED */
+
+
+typedef struct ForkSrvConfig
+{
+    bool        port[256];  /* IN PORTS FED WITH THE TEST CASE */
+    int         fork_pc;    /* SNAPSHOT PC (-1 : FIRST IN ON A FUZZED PORT) */
+    uint64_t    limit;      /* MAXIMUM GUEST CYCLES OF A TEST CASE */
+    const char *input;      /* TEST CASE FILE (NULL : STDIN) */
+} ForkSrvConfig_t;
+
+
+bool ForkSrvAtSnapshot(FemtoEmu_t *emu, ForkSrvConfig_t *cfg);
+bool ForkSrvWarmUp(FemtoEmu_t *emu, ForkSrvConfig_t *cfg, bool verbose);
+bool ForkSrvParsePorts(ForkSrvConfig_t *cfg, const char *list);
+int  ForkServer(FemtoEmu_t *emu, ForkSrvConfig_t *cfg, bool verbose);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,385 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "fuzz.h"
+#include "../common.h"
+#include "../io/io.h"
+
+
+/* THE IO CALLBACKS ARE GLOBAL, SO THERE IS ONLY ONE FUZZER AT A TIME */
+static FemtoFuzz_t *Fuzz = NULL;
+
+static const char   *FaultName[4]   = { "none", "opcode", "adrm", "stack" };
+static const uint8_t Interesting[8] = { 0x00, 0x01, 0x02, 0x0F, 0x10, 0x7F, 0x80, 0xFF };
+
+
+/*** IO CALLBACK OF THE FUZZED PORTS ***/
+static INPFUNC(FuzzIn)
+{
+    if (Fuzz->pos < Fuzz->len) return Fuzz->input[Fuzz->pos++];
+
+    /* END OF THE INPUT, END OF THE EXECUTION */
+    IOMachine()->halt = true;
+    return 0xFF;
+}
+/*** END OF IO CALLBACK ***/
+
+
+/*** HELPING FUNCTIONS ***/
+static uint64_t FuzzRand(FemtoFuzz_t *fuzz)
+{
+    /* XORSHIFT64* */
+    fuzz->rng ^= fuzz->rng >> 12;
+    fuzz->rng ^= fuzz->rng << 25;
+    fuzz->rng ^= fuzz->rng >> 27;
+    return fuzz->rng * 0x2545F4914F6CDD1Dull;
+}
+
+/* HIT COUNT BUCKETS: 1, 2, 3, 4-7, 8-15, 16-31, 32-127, 128+ */
+static uint8_t FuzzBucket(uint8_t hits)
+{
+    if (hits <= 2)   return hits;
+    if (hits == 3)   return 0x04;
+    if (hits <= 7)   return 0x08;
+    if (hits <= 15)  return 0x10;
+    if (hits <= 31)  return 0x20;
+    if (hits <= 127) return 0x40;
+    return 0x80;
+}
+
+static void FuzzSave(const char *path, const uint8_t *data, uint32_t len)
+{
+    FILE *file = fopen(path, "wb");
+
+    if (file == NULL)
+    {
+        printf("ERROR (FuzzSave): CAN'T CREATE FILE \"%s\" !!!\n", path);
+        return;
+    }
+    fwrite(data, sizeof(uint8_t), len, file);
+    fclose(file);
+}
+
+/* RESTORE THE SNAPSHOT: THE REGISTERS & ONLY THE RAM PAGES WRITTEN SINCE */
+static void FuzzReset(FemtoFuzz_t *fuzz)
+{
+    FemtoEmu_t *emu   = fuzz->emu;
+    uint16_t    dirty = DIRTY;
+
+    while (dirty != 0)
+    {
+        int page = __builtin_ctz(dirty);
+
+        memcpy(RAM + (page * PAGE_SIZE), fuzz->snap_ram + (page * PAGE_SIZE), PAGE_SIZE);
+        dirty &= (uint16_t)(dirty - 1);
+    }
+    *emu = fuzz->snap;
+}
+
+static void FuzzExec(FemtoFuzz_t *fuzz, bool verbose)
+{
+    FemtoEmu_t *emu = fuzz->emu;
+    uint64_t    end = fuzz->snap.cycles + fuzz->cfg->limit;
+
+    FuzzReset(fuzz);
+    fuzz->pos = 0;
+
+    while (!HALT && FAULT == FAULT_NONE && CYCLES < end)
+    {
+        EmuStep(emu, verbose);
+        WAIT = false;
+    }
+    fuzz->execs++;
+}
+
+/* TRUE IF THE LAST EXECUTION HIT A NEW EDGE OR A NEW HIT COUNT BUCKET, THE BITMAP IS CLEARED IN THE SAME PASS */
+static bool FuzzNewCoverage(FemtoFuzz_t *fuzz)
+{
+    bool new = false;
+
+    for (int w = 0; w < COV_SIZE / COV_LINE / 64; w++)
+    {
+        while (fuzz->cov_lines[w] != 0)
+        {
+            int      line = (w * 64) + __builtin_ctzll(fuzz->cov_lines[w]);
+            uint8_t *hits = fuzz->cov + (line * COV_LINE);
+
+            for (int j = line * COV_LINE; j < (line + 1) * COV_LINE; j++)
+            {
+                uint8_t bucket = FuzzBucket(fuzz->cov[j]);
+
+                if ((bucket & fuzz->virgin[j]) == 0) continue;
+                if (fuzz->virgin[j] == 0xFF) fuzz->edges++;
+                fuzz->virgin[j] &= (uint8_t)~bucket;
+                new = true;
+            }
+            memset(hits, 0, COV_LINE);
+            fuzz->cov_lines[w] &= fuzz->cov_lines[w] - 1;
+        }
+    }
+    return new;
+}
+
+static void FuzzAddInput(FemtoFuzz_t *fuzz)
+{
+    char path[512];
+
+    if (fuzz->count == fuzz->size)
+    {
+        fuzz->size   = (fuzz->size == 0) ? 64 : fuzz->size * 2;
+        fuzz->corpus = realloc(fuzz->corpus, fuzz->size * sizeof(FuzzInput_t));
+        if (fuzz->corpus == NULL)
+        {
+            printf("ERROR (FuzzAddInput): CAN'T GROW THE CORPUS !!!\n");
+            exit(-1);
+        }
+    }
+
+    fuzz->corpus[fuzz->count].data = malloc(fuzz->len + 1);
+    if (fuzz->corpus[fuzz->count].data == NULL)
+    {
+        printf("ERROR (FuzzAddInput): CAN'T ALLOCATE INPUT !!!\n");
+        exit(-1);
+    }
+    memcpy(fuzz->corpus[fuzz->count].data, fuzz->input, fuzz->len);
+    fuzz->corpus[fuzz->count].len = fuzz->len;
+
+    snprintf(path, sizeof(path), "%s/corpus-%06u", fuzz->out_dir, fuzz->count);
+    FuzzSave(path, fuzz->input, fuzz->len);
+    fuzz->count++;
+}
+
+static void FuzzCrash(FemtoFuzz_t *fuzz)
+{
+    FemtoEmu_t *emu = fuzz->emu;
+    uint16_t    pc  = (PC - 3) & 0xFFF;
+    char        path[512];
+
+    fuzz->crashes++;
+    if (fuzz->crashed[FAULT][pc]) return;
+    fuzz->crashed[FAULT][pc] = 1;
+
+    snprintf(path, sizeof(path), "%s/crash-%s-%03X", fuzz->out_dir, FaultName[FAULT], pc);
+    FuzzSave(path, fuzz->input, fuzz->len);
+    printf("FUZZ: NEW CRASH (%s AT 0x%03X) AFTER %llu EXECS, SAVED AS %s\n", FaultName[FAULT], pc, (unsigned long long)fuzz->execs, path);
+}
+
+/* HAVOC: A STACK OF 2 - 16 RANDOM MUTATIONS OF A CORPUS INPUT */
+static void FuzzMutate(FemtoFuzz_t *fuzz)
+{
+    FuzzInput_t *base  = &fuzz->corpus[FuzzRand(fuzz) % fuzz->count];
+    int          stack = 2 << (FuzzRand(fuzz) % 4);
+    uint32_t     at    = 0;
+
+    memcpy(fuzz->input, base->data, base->len);
+    fuzz->len = base->len;
+
+    for (int i = 0; i < stack; i++)
+    {
+        uint64_t r = FuzzRand(fuzz);
+
+        /* AN EMPTY INPUT CAN ONLY GROW */
+        if (fuzz->len == 0) r = (r & ~7ull) | 5;
+        at = (fuzz->len == 0) ? 0 : (uint32_t)((r >> 8) % fuzz->len);
+
+        switch (r & 7)
+        {
+            case 0: /* FLIP A BIT */
+                fuzz->input[at] ^= (uint8_t)(1 << ((r >> 40) & 7));
+                break;
+
+            case 1: /* RANDOM BYTE */
+                fuzz->input[at] = (uint8_t)(r >> 40);
+                break;
+
+            case 2: /* ADD / SUB 1 - 16 */
+                fuzz->input[at] += (r & (1ull << 39)) ? (uint8_t)(1 + ((r >> 40) & 15)) : (uint8_t)-(1 + ((r >> 40) & 15));
+                break;
+
+            case 3: /* INTERESTING VALUE */
+                fuzz->input[at] = Interesting[(r >> 40) & 7];
+                break;
+
+            case 4: /* DELETE A BYTE */
+                if (fuzz->len > 1)
+                {
+                    memmove(fuzz->input + at, fuzz->input + at + 1, fuzz->len - at - 1);
+                    fuzz->len--;
+                }
+                break;
+
+            case 5: /* INSERT A BYTE */
+                if (fuzz->len < FUZZ_MAX_INPUT)
+                {
+                    memmove(fuzz->input + at + 1, fuzz->input + at, fuzz->len - at);
+                    fuzz->input[at] = (uint8_t)(r >> 40);
+                    fuzz->len++;
+                }
+                break;
+
+            case 6: /* SPLICE: THE TAIL COME FROM ANOTHER CORPUS INPUT */
+            {
+                FuzzInput_t *other = &fuzz->corpus[(r >> 40) % fuzz->count];
+                uint32_t     tail  = (other->len > at) ? other->len - at : 0;
+
+                memcpy(fuzz->input + at, other->data + (other->len - tail), tail);
+                if (tail > 0) fuzz->len = at + tail;
+                break;
+            }
+
+            default: /* APPEND A BYTE */
+                if (fuzz->len < FUZZ_MAX_INPUT) fuzz->input[fuzz->len++] = (uint8_t)(r >> 40);
+                break;
+        }
+    }
+}
+/*** END OF HELPING FUNCTIONS ***/
+
+
+FemtoFuzz_t * FuzzInit(FemtoEmu_t *emu, ForkSrvConfig_t *cfg, const char *out_dir, bool verbose)
+{
+    FemtoFuzz_t *fuzz = NULL;
+    FILE        *seed = NULL;
+
+
+    /*** SNAPSHOT: RUN ONCE UNTIL THE SNAPSHOT POINT ***/
+    if (!ForkSrvWarmUp(emu, cfg, verbose)) exit(-1);
+
+    fuzz = calloc(1, sizeof(FemtoFuzz_t));
+    if (fuzz == NULL)
+    {
+        printf("ERROR (FuzzInit): CAN'T ALLOCATE FUZZER STATE !!!\n");
+        exit(-1);
+    }
+    fuzz->emu     = emu;
+    fuzz->cfg     = cfg;
+    fuzz->out_dir = out_dir;
+    fuzz->rng     = 0x9E3779B97F4A7C15ull;
+    memset(fuzz->virgin, 0xFF, COV_SIZE);
+
+    emu->cov       = fuzz->cov;
+    emu->cov_lines = fuzz->cov_lines;
+    emu->cov_prev  = 0;
+    emu->dirty     = 0;
+    memcpy(fuzz->snap_ram, emu->ram, sizeof(fuzz->snap_ram));
+    fuzz->snap     = *emu;
+
+    for (int p = 0; p < 256; p++)
+    {
+        if (cfg->port[p]) RegisterInputFunc(FuzzIn, (uint8_t)p);
+    }
+    Fuzz = fuzz;
+
+    if (mkdir(out_dir, 0755) != 0 && errno != EEXIST)
+    {
+        printf("ERROR (FuzzInit): CAN'T CREATE DIRECTORY \"%s\" !!!\n", out_dir);
+        exit(-1);
+    }
+
+
+    /*** SEED: THE INPUT FILE, OR A SINGLE NULL BYTE ***/
+    fuzz->len = 1;
+    if (cfg->input != NULL)
+    {
+        seed = fopen(cfg->input, "rb");
+        if (seed == NULL)
+        {
+            printf("ERROR (FuzzInit): CAN'T OPEN FILE \"%s\" !!!\n", cfg->input);
+            exit(-1);
+        }
+        fuzz->len = (uint32_t)fread(fuzz->input, sizeof(uint8_t), FUZZ_MAX_INPUT, seed);
+        fclose(seed);
+    }
+
+    FuzzExec(fuzz, verbose);
+    if (FAULT != FAULT_NONE) FuzzCrash(fuzz);
+    FuzzNewCoverage(fuzz);
+    FuzzAddInput(fuzz);
+
+    if (verbose == true) printf("FUZZ: SNAPSHOT AT 0x%03X, SEED OF %u BYTES HIT %u EDGES\n", fuzz->snap.pc, fuzz->len, fuzz->edges);
+    return fuzz;
+}
+
+
+void FuzzRun(FemtoFuzz_t *fuzz, uint64_t execs, bool verbose)
+{
+    FemtoEmu_t      *emu = fuzz->emu;
+    struct timespec  start, stop;
+
+    printf("FUZZ: STARTING %llu EXECUTIONS\n", (unsigned long long)execs);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (uint64_t i = 0; i < execs; i++)
+    {
+        FuzzMutate(fuzz);
+        FuzzExec(fuzz, verbose);
+
+        if (FAULT != FAULT_NONE)
+        {
+            /* A CRASHING PATH IS NOT ADDED TO THE CORPUS, ONLY ITS BITMAP IS CLEARED */
+            FuzzCrash(fuzz);
+            memset(fuzz->cov, 0, COV_SIZE);
+            memset(fuzz->cov_lines, 0, sizeof(fuzz->cov_lines));
+        }
+        else if (FuzzNewCoverage(fuzz))
+        {
+            FuzzAddInput(fuzz);
+            if (verbose == true) printf("FUZZ: NEW INPUT %u (%u BYTES), %u EDGES\n", fuzz->count - 1, fuzz->len, fuzz->edges);
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    fuzz->seconds += (double)(stop.tv_sec - start.tv_sec) + (double)(stop.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+
+void FuzzReport(FemtoFuzz_t *fuzz)
+{
+    printf("FUZZ: %llu EXECS IN %.2f S (%.0f EXECS/S)\n", (unsigned long long)fuzz->execs, fuzz->seconds,
+           (fuzz->seconds > 0.0) ? (double)fuzz->execs / fuzz->seconds : 0.0);
+    printf("FUZZ: %u INPUTS IN THE CORPUS, %u EDGES, %llu CRASHES\n", fuzz->count, fuzz->edges, (unsigned long long)fuzz->crashes);
+}
+
+
+void FuzzQuit(FemtoFuzz_t *fuzz)
+{
+    for (uint32_t i = 0; i < fuzz->count; i++)
+    {
+        free(fuzz->corpus[i].data);
+    }
+    free(fuzz->corpus);
+    fuzz->emu->cov       = NULL;
+    fuzz->emu->cov_lines = NULL;
+    if (Fuzz == fuzz) Fuzz = NULL;
+    free(fuzz);
+}
\ No newline at end of file
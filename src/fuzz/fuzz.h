@@ -0,0 +1,93 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+/* IN-PROCESS FUZZER:
+ * - SAME TARGET AS THE FORK SERVER (FUZZED PORTS, SNAPSHOT POINT, CYCLES LIMIT), BUT EACH EXECUTION
+ *   RESTART FROM AN IN-MEMORY SNAPSHOT: THE REGISTERS ARE COPIED BACK AND ONLY THE RAM PAGES
+ *   WRITTEN BY THE LAST EXECUTION (emu->dirty) ARE RESTORED
+ * - AN INPUT IS KEPT IN THE CORPUS WHEN IT HIT A NEW EDGE OR A NEW HIT COUNT BUCKET OF AN EDGE, ONLY
+ *   THE LINES OF THE BITMAP WRITTEN BY THE EXECUTION (emu->cov_lines) ARE SCANNED & CLEARED
+ * - A GUEST FAULT IS A CRASH, THE FIRST INPUT OF EACH (FAULT, PC) IS SAVED AS A REPRODUCER
+ *   IN THE OUTPUT DIRECTORY (crash-<FAULT>-<PC>), THE CORPUS IS SAVED THERE TOO (corpus-<N>)
+ * - A REPRODUCER CAN BE REPLAYED WITH --forkserver PORTS --input FILE
+ */
+
+#ifndef FUZZ_H_
+#define FUZZ_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "forksrv.h"
+#include "../femto.h"
+#include "../cpu/cpu.h"
+
+#define FUZZ_EXECS      1000000   /* DEFAULT NUMBER OF EXECUTIONS */
+#define FUZZ_MAX_INPUT  1024      /* MUTATED INPUTS ARE NEVER LONGER */
+#define FUZZ_OUT_DIR    "fuzz-out"
+
+
+typedef struct FuzzInput
+{
+    uint8_t  *data;
+    uint32_t  len;
+} FuzzInput_t;
+
+typedef struct FemtoFuzz
+{
+    FemtoEmu_t      *emu;                   /* MACHINE RUNNING THE INPUTS */
+    FemtoEmu_t       snap;                  /* REGISTERS AT THE SNAPSHOT POINT */
+    uint8_t          snap_ram[4 * 1024];    /* RAM AT THE SNAPSHOT POINT */
+    ForkSrvConfig_t *cfg;
+    const char      *out_dir;
+
+    uint8_t          cov[COV_SIZE];         /* EDGE HIT COUNTS OF THE LAST EXECUTION */
+    uint64_t         cov_lines[COV_SIZE / COV_LINE / 64]; /* LINES OF cov TO SCAN */
+    uint8_t          virgin[COV_SIZE];      /* HIT COUNT BUCKETS NEVER SEEN, PER EDGE */
+    uint8_t          crashed[4][0x1000];    /* (FAULT, PC) ALREADY SAVED */
+
+    FuzzInput_t     *corpus;
+    uint32_t         count;
+    uint32_t         size;
+
+    uint8_t          input[FUZZ_MAX_INPUT]; /* CURRENT INPUT & READ POSITION OF THE FUZZED PORTS */
+    uint32_t         len;
+    uint32_t         pos;
+
+    uint64_t         rng;
+    uint64_t         execs;
+    uint64_t         crashes;
+    uint32_t         edges;
+    double           seconds;               /* HOST TIME SPENT IN FuzzRun */
+} FemtoFuzz_t;
+
+
+FemtoFuzz_t * FuzzInit(FemtoEmu_t *emu, ForkSrvConfig_t *cfg, const char *out_dir, bool verbose);
+void          FuzzRun(FemtoFuzz_t *fuzz, uint64_t execs, bool verbose);
+void          FuzzReport(FemtoFuzz_t *fuzz);
+void          FuzzQuit(FemtoFuzz_t *fuzz);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,180 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+#include <stdio.h>
+#include "coproc.h"
+#include "io.h"
+#include "../cpu/event.h"
+#include "../cpu/int.h"
+
+
+typedef struct FemtoCoproc
+{
+    FemtoEmu_t *emu;
+    uint16_t    a;
+    uint16_t    b;
+    uint8_t     cmd;
+    uint8_t     status;
+    uint32_t    result;
+    uint64_t    ops;
+    uint64_t    errors;
+} FemtoCoproc_t;
+
+
+/* THE IO CALLBACKS ARE GLOBAL, SO THERE IS ONLY ONE COPROCESSOR AT A TIME */
+static FemtoCoproc_t Coproc;
+
+
+/*** HELPING FUNCTIONS ***/
+static uint32_t CoprocSqrt(uint32_t x)
+{
+    uint32_t root = 0;
+
+    /* BIT BY BIT, EXACT FLOOR */
+    for (uint32_t bit = 1u << 14; bit != 0; bit >>= 2)
+    {
+        if (x >= root + bit)
+        {
+            x    -= root + bit;
+            root  = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+    }
+    return root;
+}
+
+static void CoprocComplete(FemtoEmu_t *emu, void *arg)
+{
+    (void)arg;
+
+    Coproc.status = COPROC_DONE;
+    Coproc.ops++;
+    if (Coproc.cmd & COPROC_IRQ) IREQ_LINE(emu, COPROC_IRQ_LINE)
+}
+/*** END OF HELPING FUNCTIONS ***/
+
+
+/*** IO CALLBACKS ***/
+static OUTFUNC(CoprocOperand, data)
+{
+    uint16_t *reg = ((IOPort() & 0xFE) == COPROC_A_PORT) ? &Coproc.a : &Coproc.b;
+
+    if ((IOPort() & 0x01) == 0) *reg = (*reg & 0xFF00) | data;
+    else                        *reg = (uint16_t)((*reg & 0x00FF) | (data << 8));
+}
+
+static OUTFUNC(CoprocCommand, data)
+{
+    uint64_t cost = 0;
+
+    if (Coproc.status & COPROC_BUSY)
+    {
+        Coproc.status |= COPROC_ERROR;
+        Coproc.errors++;
+        return;
+    }
+
+    /* THE RESULT IS A SINGLE HOST OPERATION, ONLY ITS VISIBILITY IS DELAYED */
+    switch (data & 0x7F)
+    {
+        case COPROC_MUL:
+            Coproc.result = (uint32_t)Coproc.a * Coproc.b;
+            cost          = COPROC_MUL_CYCLES;
+            break;
+        case COPROC_DIV:
+        case COPROC_MOD:
+            if (Coproc.b == 0)
+            {
+                Coproc.status = COPROC_ERROR;
+                Coproc.errors++;
+                return;
+            }
+            Coproc.result = ((data & 0x7F) == COPROC_DIV) ? ((uint32_t)(Coproc.a % Coproc.b) << 16) | (Coproc.a / Coproc.b)
+                                                          : (uint32_t)(Coproc.a % Coproc.b);
+            cost          = COPROC_DIV_CYCLES;
+            break;
+        case COPROC_SQRT:
+            Coproc.result = CoprocSqrt(Coproc.a);
+            cost          = COPROC_SQRT_CYCLES;
+            break;
+        default:
+            Coproc.status = COPROC_ERROR;
+            Coproc.errors++;
+            return;
+    }
+
+    Coproc.cmd    = data;
+    Coproc.status = COPROC_BUSY;
+    EventAdd(Coproc.emu, Coproc.emu->cycles + cost, CoprocComplete, NULL);
+}
+
+static INPFUNC(CoprocStatus)
+{
+    return Coproc.status;
+}
+
+static INPFUNC(CoprocResult)
+{
+    if (Coproc.status & COPROC_BUSY)
+    {
+        IOWait();
+        return 0xFF;
+    }
+    return (uint8_t)(Coproc.result >> (8 * (IOPort() - COPROC_RES_PORT)));
+}
+/*** END OF IO CALLBACKS ***/
+
+
+/* MUST BE CALLED AFTER IOInit() (EmuInit) */
+void CoprocInit(FemtoEmu_t *emu, bool verbose)
+{
+    Coproc     = (FemtoCoproc_t){0};
+    Coproc.emu = emu;
+
+    for (uint8_t port = COPROC_A_PORT; port < COPROC_CMD_PORT; port++)
+    {
+        RegisterOutputFunc(CoprocOperand, port);
+    }
+    RegisterOutputFunc(CoprocCommand, COPROC_CMD_PORT);
+    RegisterInputFunc(CoprocStatus, COPROC_CMD_PORT);
+    IOPollable(COPROC_CMD_PORT);
+    for (uint8_t port = COPROC_RES_PORT; port < COPROC_RES_PORT + 4; port++)
+    {
+        RegisterInputFunc(CoprocResult, port);
+    }
+
+    if (verbose == true) printf("COPROC: PORTS 0x%02X - 0x%02X\n", COPROC_A_PORT, COPROC_RES_PORT + 3);
+}
+
+
+void CoprocReport(void)
+{
+    printf("COPROC: %llu OPERATIONS, %llu ERRORS\n", (unsigned long long)Coproc.ops, (unsigned long long)Coproc.errors);
+}
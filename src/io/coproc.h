@@ -0,0 +1,74 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+/* MATH COPROCESSOR:
+ * - OUT COPROC_A_PORT / +1 : OPERAND A (16BITS), LOW BYTE THEN HIGH BYTE
+ * - OUT COPROC_B_PORT / +1 : OPERAND B (16BITS), LOW BYTE THEN HIGH BYTE
+ * - OUT COPROC_CMD_PORT    : START AN OPERATION, + COPROC_IRQ TO RAISE COPROC_IRQ_LINE ON COMPLETION
+ *     COPROC_MUL  : RESULT = A x B (32BITS)
+ *     COPROC_DIV  : RESULT = A / B (BYTES 0-1), A % B (BYTES 2-3)
+ *     COPROC_MOD  : RESULT = A % B
+ *     COPROC_SQRT : RESULT = FLOOR(SQRT(A))
+ * - IN  COPROC_CMD_PORT    : STATUS, BIT 0 BUSY, BIT 1 DONE, BIT 2 ERROR (DIVISION BY ZERO, UNKNOWN
+ *                            OPERATION OR START WHILE BUSY)
+ * - IN  COPROC_RES_PORT + n: BYTE n OF THE RESULT (LITTLE-ENDIAN); WHILE BUSY THE IN IS RETRIED, SO
+ *                            THE GUEST CAN READ THE RESULT RIGHT AFTER THE START
+ * - COST IN GUEST CYCLES, FROM THE START TO THE RESULT: MUL 4, DIV & MOD 16, SQRT 12
+ */
+
+#ifndef COPROC_H_
+#define COPROC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../femto.h"
+
+#define COPROC_A_PORT      0x90
+#define COPROC_B_PORT      0x92
+#define COPROC_CMD_PORT    0x94
+#define COPROC_RES_PORT    0x95    /* 4 PORTS */
+
+#define COPROC_MUL         0x01
+#define COPROC_DIV         0x02
+#define COPROC_MOD         0x03
+#define COPROC_SQRT        0x04
+#define COPROC_IRQ         0x80
+
+#define COPROC_BUSY        0x01
+#define COPROC_DONE        0x02
+#define COPROC_ERROR       0x04
+
+#define COPROC_IRQ_LINE    6       /* LINE OF THE INTERRUPT CONTROLLER */
+#define COPROC_MUL_CYCLES  4
+#define COPROC_DIV_CYCLES  16
+#define COPROC_SQRT_CYCLES 12
+
+
+void CoprocInit(FemtoEmu_t *emu, bool verbose);
+void CoprocReport(void);
+
+#endif
@@ -0,0 +1,291 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include "device.h"
+#include "io.h"
+#include "../cpu/int.h"
+
+
+/* A MAILBOX ENTRY: KIND << 16 | PORT << 8 | DATA */
+#define DEVICE_MSG_WRITE  0
+#define DEVICE_MSG_READ   1
+#define DEVICE_MSG_QUIT   2
+#define DEVICE_MSG(k, p, d)  (((uint32_t)(k) << 16) | ((uint32_t)(p) << 8) | (d))
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DEVICE_RELAX()  __builtin_ia32_pause()
+#else
+#define DEVICE_RELAX()
+#endif
+
+
+/* OWNER OF EACH PORT, TO REFUSE OVERLAPPING DEVICES */
+static FemtoDevice_t *Device[256] = {NULL};
+
+
+/*** HELPING FUNCTIONS ***/
+static long DeviceFutex(uint32_t *addr, int op, uint32_t val)
+{
+    return syscall(SYS_futex, addr, op, val, NULL, NULL, 0);
+}
+
+/* CPU THREAD: FALSE WHEN THE MAILBOX IS FULL */
+static bool DevicePost(FemtoDevice_t *dev, uint32_t msg)
+{
+    uint32_t head = dev->head;
+
+    if (head - __atomic_load_n(&dev->tail, __ATOMIC_ACQUIRE) == DEVICE_MAILBOX) return false;
+
+    dev->box[head & (DEVICE_MAILBOX - 1)] = msg;
+
+    /* SEQ_CST: THE STORE OF head MUST NOT PASS THE LOAD OF sleeping, THE DEVICE DO THE OPPOSITE */
+    __atomic_store_n(&dev->head, head + 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&dev->sleeping, __ATOMIC_SEQ_CST))
+    {
+        DeviceFutex(&dev->head, FUTEX_WAKE_PRIVATE, 1);
+        dev->wakes++;
+    }
+    return true;
+}
+
+static void * DeviceThread(void *arg)
+{
+    FemtoDevice_t *dev  = arg;
+    uint32_t       tail = 0;
+    int            spin = 0;
+
+    while (true)
+    {
+        uint32_t msg  = 0;
+        uint8_t  port = 0;
+
+        if (__atomic_load_n(&dev->head, __ATOMIC_ACQUIRE) == tail)
+        {
+            if (++spin < DEVICE_SPIN)
+            {
+                DEVICE_RELAX();
+                continue;
+            }
+
+            __atomic_store_n(&dev->sleeping, 1, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&dev->head, __ATOMIC_SEQ_CST) == tail)
+            {
+                /* RETURN AT ONCE IF head IS NO MORE tail */
+                DeviceFutex(&dev->head, FUTEX_WAIT_PRIVATE, tail);
+                dev->sleeps++;
+            }
+            __atomic_store_n(&dev->sleeping, 0, __ATOMIC_RELAXED);
+            spin = 0;
+            continue;
+        }
+
+        msg  = dev->box[tail & (DEVICE_MAILBOX - 1)];
+        port = (uint8_t)(msg >> 8);
+
+        /* POSTED BY DeviceStop AFTER EVERY OTHER MESSAGE, SO THE MAILBOX IS DRAINED */
+        if ((msg >> 16) == DEVICE_MSG_QUIT) break;
+
+        if ((msg >> 16) == DEVICE_MSG_READ)
+        {
+            dev->answer[port - dev->base] = (dev->read != NULL) ? dev->read(dev, port) : 0xFF;
+            __atomic_store_n(&dev->ready[port - dev->base], true, __ATOMIC_RELEASE);
+        }
+        else
+        {
+            dev->write(dev, port, (uint8_t)msg);
+        }
+
+        /* THE REGISTERS PUBLISHED BY THE CALLBACK ARE VISIBLE WITH tail */
+        __atomic_store_n(&dev->tail, ++tail, __ATOMIC_RELEASE);
+        spin = 0;
+    }
+    return NULL;
+}
+/*** END OF HELPING FUNCTIONS ***/
+
+
+/*** IO CALLBACKS ***/
+static void DeviceOut(FemtoEmu_t *emu, void *ctx, uint8_t io_port, uint8_t data)
+{
+    FemtoDevice_t *dev = ctx;
+
+    (void)emu;
+
+    if (DevicePost(dev, DEVICE_MSG(DEVICE_MSG_WRITE, io_port, data)))
+    {
+        dev->outs++;
+        return;
+    }
+    dev->waits++;
+    IOWait();
+}
+
+static uint8_t DeviceIn(FemtoEmu_t *emu, void *ctx, uint8_t io_port)
+{
+    FemtoDevice_t *dev = ctx;
+    uint8_t        reg = (uint8_t)(io_port - dev->base);
+
+    (void)emu;
+
+    if (!dev->request[reg])
+    {
+        /* THE VALUE IS ONLY CURRENT WHEN EVERY OUT POSTED BEFORE IS CONSUMED */
+        if (__atomic_load_n(&dev->tail, __ATOMIC_ACQUIRE) == dev->head) return __atomic_load_n(&dev->value[reg], __ATOMIC_RELAXED);
+    }
+    else if (__atomic_load_n(&dev->ready[reg], __ATOMIC_ACQUIRE))
+    {
+        dev->ready[reg] = false;
+        dev->asked[reg] = false;
+        return dev->answer[reg];
+    }
+    else if (!dev->asked[reg] && DevicePost(dev, DEVICE_MSG(DEVICE_MSG_READ, io_port, 0)))
+    {
+        dev->asked[reg] = true;
+        dev->reads++;
+    }
+
+    dev->waits++;
+    IOWait();
+    return 0xFF;
+}
+/*** END OF IO CALLBACKS ***/
+
+
+/* MUST BE CALLED AFTER IOInit() (EmuInit); read CAN BE NULL WITHOUT DeviceReadPort */
+FemtoDevice_t * DeviceCreate(FemtoEmu_t *emu, const char *name, uint8_t base, uint8_t count,
+                             DeviceWriteFunc write, DeviceReadFunc read, void *ctx, bool verbose)
+{
+    FemtoDevice_t *dev = NULL;
+
+    if (count == 0 || count > DEVICE_PORTS || base + count > 256)
+    {
+        printf("ERROR (DeviceCreate): BAD PORT RANGE 0x%02X + %u FOR %s !!!\n", base, count, name);
+        exit(-1);
+    }
+    for (int p = base; p < base + count; p++)
+    {
+        if (Device[p] == NULL) continue;
+        printf("ERROR (DeviceCreate): PORT 0x%02X OF %s IS ALREADY OWNED BY %s !!!\n", p, name, Device[p]->name);
+        exit(-1);
+    }
+
+    dev = aligned_alloc(64, sizeof(FemtoDevice_t));
+    if (dev == NULL)
+    {
+        printf("ERROR (DeviceCreate): CAN'T ALLOCATE DEVICE %s !!!\n", name);
+        exit(-1);
+    }
+    memset(dev, 0, sizeof(FemtoDevice_t));
+    dev->emu   = emu;
+    dev->name  = name;
+    dev->base  = base;
+    dev->count = count;
+    dev->write = write;
+    dev->read  = read;
+    dev->ctx   = ctx;
+
+    for (int p = base; p < base + count; p++)
+    {
+        Device[p] = dev;
+        IORegisterOut((uint8_t)p, DeviceOut, dev);
+        IORegisterIn((uint8_t)p, DeviceIn, dev);
+        IOPollable((uint8_t)p);
+    }
+
+    if (pthread_create(&dev->thread, NULL, DeviceThread, dev) != 0)
+    {
+        printf("ERROR (DeviceCreate): CAN'T CREATE THE THREAD OF %s !!!\n", name);
+        exit(-1);
+    }
+    dev->running = true;
+    if (verbose == true) printf("DEVICE: %s THREADED, PORTS 0x%02X - 0x%02X\n", name, base, base + count - 1);
+    return dev;
+}
+
+
+/* THE IN OF port POP SOMETHING, IT IS ANSWERED BY THE DEVICE THREAD (read) */
+void DeviceReadPort(FemtoDevice_t *dev, uint8_t port)
+{
+    /* IORegisterIn CLEAR THE POLLABLE FLAG */
+    dev->request[port - dev->base] = true;
+    IORegisterIn(port, DeviceIn, dev);
+}
+
+
+/* DEVICE THREAD (OR BEFORE THE EMULATION): PUBLISH THE VALUE READ BY AN IN OF port */
+void DeviceSet(FemtoDevice_t *dev, uint8_t port, uint8_t value)
+{
+    __atomic_store_n(&dev->value[port - dev->base], value, __ATOMIC_RELAXED);
+}
+
+
+void DeviceIrq(FemtoDevice_t *dev, uint8_t line)
+{
+    IREQ_LINE(dev->emu, line)
+}
+
+
+/* PROCESS THE MAILBOX TO ITS END, THEN JOIN THE DEVICE THREAD */
+void DeviceStop(FemtoDevice_t *dev)
+{
+    const struct timespec full = { 0, 100000 };   /* 100us */
+
+    if (!dev->running) return;
+
+    while (!DevicePost(dev, DEVICE_MSG(DEVICE_MSG_QUIT, 0, 0)))
+    {
+        nanosleep(&full, NULL);
+    }
+    pthread_join(dev->thread, NULL);
+    dev->running = false;
+}
+
+
+void DeviceReport(FemtoDevice_t *dev)
+{
+    printf("DEVICE: %s: %llu OUT POSTED, %llu READ REQUESTS, %llu IN/OUT RETRIED, %llu WAKE-UPS, %llu SLEEPS\n", dev->name,
+           (unsigned long long)dev->outs, (unsigned long long)dev->reads, (unsigned long long)dev->waits,
+           (unsigned long long)dev->wakes, (unsigned long long)dev->sleeps);
+}
+
+
+void DeviceQuit(FemtoDevice_t *dev)
+{
+    DeviceStop(dev);
+    for (int p = dev->base; p < dev->base + dev->count; p++)
+    {
+        Device[p] = NULL;
+    }
+    free(dev);
+}
@@ -0,0 +1,108 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+/* THREADED DEVICE FRAMEWORK:
+ * - A DEVICE OWN A RANGE OF PORTS AND IS RUN BY ITS OWN HOST THREAD, SO A SLOW OPERATION (A
+ *   STORAGE TRANSFER, A FRAME, A BLOCK OF SAMPLES) NEVER STALL THE CPU THREAD
+ * - AN OUT IS POSTED IN THE COMMAND MAILBOX (SPSC RING, CPU -> DEVICE) AND THE CPU CONTINUE AT
+ *   ONCE; THE DEVICE THREAD CALL write(dev, port, data) FOR EACH OF THEM, IN ORDER. THE CPU ONLY
+ *   WAIT (IOWait) WHEN THE MAILBOX IS FULL
+ * - THE DEVICE PUBLISH ITS REGISTERS WITH DeviceSet. AN IN RETURN THE PUBLISHED VALUE AS SOON AS
+ *   THE DEVICE HAS CONSUMED EVERY OUT POSTED BEFORE IT, SO THE GUEST ALWAYS READ A VALUE
+ *   CONSISTENT WITH ITS OWN WRITES; UNTIL THEN THE IN IS RETRIED
+ * - A PORT DECLARED WITH DeviceReadPort HAS A READ WITH SIDE EFFECT (A FIFO POP): ITS IN IS POSTED
+ *   AS A READ REQUEST, THE DEVICE THREAD ANSWER WITH read(dev, port) AND THE IN IS RETRIED UNTIL
+ *   THE ANSWER IS BACK
+ * - THE DEVICE THREAD RAISE AN INTERRUPT WITH DeviceIrq (ATOMIC OR IN emu->ireq)
+ * - ON AN EMPTY MAILBOX THE DEVICE THREAD SPIN SHORTLY, THEN SLEEP ON A FUTEX; THE CPU ONLY DO
+ *   THE WAKE-UP SYSCALL WHEN THE DEVICE THREAD SLEEPS
+ * - A THREADED DEVICE RUN IN HOST TIME: ITS OPERATIONS COMPLETE AS FAST AS THE HOST DO THEM, NOT
+ *   AFTER A COUNT OF GUEST CYCLES
+ */
+
+#ifndef DEVICE_H_
+#define DEVICE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "../femto.h"
+
+#define DEVICE_MAILBOX   1024     /* POSTED IN/OUT, A POWER OF 2 */
+#define DEVICE_PORTS     16       /* MAXIMUM PORTS OF A DEVICE */
+#define DEVICE_SPIN      4096     /* POLLS OF AN EMPTY MAILBOX BEFORE THE DEVICE THREAD SLEEPS */
+
+
+typedef struct FemtoDevice FemtoDevice_t;
+
+/* CALLED BY THE DEVICE THREAD, port IS THE ABSOLUTE PORT NUMBER */
+typedef void    (*DeviceWriteFunc)(FemtoDevice_t *dev, uint8_t port, uint8_t data);
+typedef uint8_t (*DeviceReadFunc)(FemtoDevice_t *dev, uint8_t port);
+
+struct FemtoDevice
+{
+    /* PRODUCER & CONSUMER INDEXES ARE FREE RUNNING, ON THEIR OWN CACHE LINE */
+    uint32_t         head __attribute__((aligned(64)));   /* WRITTEN BY THE CPU THREAD */
+    uint32_t         sleeping;                            /* THE DEVICE THREAD WAIT ON head */
+    uint32_t         tail __attribute__((aligned(64)));   /* WRITTEN BY THE DEVICE THREAD */
+    uint32_t         box[DEVICE_MAILBOX] __attribute__((aligned(64)));
+
+    /* DEVICE -> CPU: PUBLISHED REGISTERS AND ANSWERS OF THE READ REQUESTS */
+    uint8_t          value[DEVICE_PORTS];
+    uint8_t          answer[DEVICE_PORTS];
+    bool             ready[DEVICE_PORTS];      /* answer IS VALID, SET BY THE DEVICE, CLEARED BY THE CPU */
+    bool             asked[DEVICE_PORTS];      /* READ REQUEST IN FLIGHT, CPU THREAD ONLY */
+    bool             request[DEVICE_PORTS];    /* PORT WITH A READ SIDE EFFECT */
+
+    FemtoEmu_t      *emu;
+    const char      *name;
+    uint8_t          base;
+    uint8_t          count;
+    DeviceWriteFunc  write;
+    DeviceReadFunc   read;
+    void            *ctx;                      /* FREE FOR THE DEVICE */
+    bool             running;
+    pthread_t        thread;
+
+    uint64_t         outs;       /* OUT POSTED */
+    uint64_t         reads;      /* READ REQUESTS POSTED */
+    uint64_t         waits;      /* IN/OUT RETRIED */
+    uint64_t         wakes;      /* FUTEX WAKE-UP DONE BY THE CPU */
+    uint64_t         sleeps;     /* FUTEX WAIT DONE BY THE DEVICE */
+};
+
+
+FemtoDevice_t * DeviceCreate(FemtoEmu_t *emu, const char *name, uint8_t base, uint8_t count,
+                             DeviceWriteFunc write, DeviceReadFunc read, void *ctx, bool verbose);
+void            DeviceReadPort(FemtoDevice_t *dev, uint8_t port);
+void            DeviceSet(FemtoDevice_t *dev, uint8_t port, uint8_t value);
+void            DeviceIrq(FemtoDevice_t *dev, uint8_t line);
+void            DeviceStop(FemtoDevice_t *dev);
+void            DeviceReport(FemtoDevice_t *dev);
+void            DeviceQuit(FemtoDevice_t *dev);
+
+#endif
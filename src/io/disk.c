@@ -0,0 +1,310 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "disk.h"
+#include "io.h"
+#include "device.h"
+#include "../cpu/cpu.h"
+#include "../cpu/event.h"
+#include "../cpu/int.h"
+
+
+typedef struct FemtoDisk
+{
+    FemtoEmu_t    *emu;
+    FemtoDevice_t *dev;         /* THREADED DISK (NULL : EVENT DRIVEN) */
+    uint8_t       *base;        /* MAPPED IMAGE */
+    uint8_t       *over;        /* MAPPED OVERLAY (NULL : WRITES GO TO THE IMAGE) */
+    uint8_t       *cow;         /* 1 BIT PER SECTOR OF THE OVERLAY, STORED AFTER ITS SECTORS */
+    size_t         size;        /* BYTES OF THE IMAGE */
+    size_t         map_over;    /* BYTES OF THE OVERLAY MAPPING */
+    uint32_t       sectors;
+    uint16_t       lba;
+    uint16_t       addr;
+    uint16_t       run_lba;     /* REGISTERS LATCHED BY THE START, THE ONLY ONES USED BY THE TRANSFER */
+    uint16_t       run_addr;
+    uint8_t        cmd;
+    uint8_t        status;
+    size_t         dirty_lo;    /* HOST BYTES WRITTEN SINCE THE LAST FLUSH [lo, hi) */
+    size_t         dirty_hi;
+    uint64_t       reads;
+    uint64_t       writes;
+    uint64_t       flushes;
+    uint64_t       errors;
+} FemtoDisk_t;
+
+
+/* THE IO CALLBACKS ARE GLOBAL, SO THERE IS ONLY ONE DISK AT A TIME */
+static FemtoDisk_t Disk;
+
+
+/*** HELPING FUNCTIONS ***/
+/* ONLY THE OVERLAY IS CREATED (create), A MISSING IMAGE IS AN ERROR, NOT AN EMPTY DISK */
+static uint8_t * DiskMap(const char *path, bool write, bool create, size_t size, size_t *mapped)
+{
+    struct stat st;
+    int         fd  = open(path, (write ? O_RDWR : O_RDONLY) | (create ? O_CREAT : 0), 0644);
+    void       *map = NULL;
+
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+        printf("ERROR (DiskMap): CAN'T OPEN FILE \"%s\" !!!\n", path);
+        exit(-1);
+    }
+
+    /* size == 0 : THE WHOLE FILE; ELSE THE FILE IS EXTENDED (SPARSE) TO size */
+    if (size == 0) size = (size_t)st.st_size;
+    if ((size_t)st.st_size < size && ftruncate(fd, (off_t)size) != 0)
+    {
+        printf("ERROR (DiskMap): CAN'T EXTEND FILE \"%s\" !!!\n", path);
+        exit(-1);
+    }
+    if (size < DISK_SECTOR)
+    {
+        printf("ERROR (DiskMap): FILE \"%s\" IS SMALLER THAN A SECTOR !!!\n", path);
+        exit(-1);
+    }
+
+    map = mmap(NULL, size, write ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        printf("ERROR (DiskMap): CAN'T MAP FILE \"%s\" !!!\n", path);
+        exit(-1);
+    }
+
+    *mapped = size;
+    return map;
+}
+
+static void DiskFlush(int flags)
+{
+    size_t mask = ~(size_t)(sysconf(_SC_PAGESIZE) - 1);
+    size_t lo   = Disk.dirty_lo & mask;
+
+    if (Disk.dirty_hi <= Disk.dirty_lo) return;
+
+    /* msync WANT PAGE ALIGNED ADDRESSES; THE BITMAP OF THE OVERLAY CHANGED WITH ITS SECTORS */
+    if (Disk.over == NULL)
+    {
+        msync(Disk.base + lo, Disk.dirty_hi - lo, flags);
+    }
+    else
+    {
+        msync(Disk.over + lo, Disk.dirty_hi - lo, flags);
+        msync(Disk.over + (Disk.size & mask), Disk.map_over - (Disk.size & mask), flags);
+    }
+
+    Disk.dirty_lo = Disk.map_over;
+    Disk.dirty_hi = 0;
+    Disk.flushes++;
+}
+
+/* DONE BY THE CPU THREAD (EVENT) OR BY THE DEVICE THREAD (THREADED DISK) */
+static void DiskTransfer(FemtoEmu_t *emu)
+{
+    size_t   offset = (size_t)Disk.run_lba * DISK_SECTOR;
+    uint16_t lba    = Disk.run_lba;
+    uint16_t addr   = Disk.run_addr;
+    uint8_t *sector = NULL;
+
+    switch (Disk.cmd & 0x7F)
+    {
+        case DISK_READ:
+            sector = (Disk.over != NULL && (Disk.cow[lba >> 3] >> (lba & 7)) & 1) ? Disk.over : Disk.base;
+            memcpy(RAM + addr, sector + offset, DISK_SECTOR);
+
+            /* ATOMIC, THE CPU THREAD MAY MARK OTHER PAGES AT THE SAME TIME */
+            for (uint32_t a = addr & ~(PAGE_SIZE - 1); a < (uint32_t)addr + DISK_SECTOR; a += PAGE_SIZE)
+            {
+                __atomic_fetch_or(&DIRTY, (uint16_t)(1u << ((a >> 8) & 0xF)), __ATOMIC_RELAXED);
+            }
+            Disk.reads++;
+            break;
+
+        case DISK_WRITE:
+            sector = (Disk.over != NULL) ? Disk.over : Disk.base;
+            memcpy(sector + offset, RAM + addr, DISK_SECTOR);
+            if (Disk.over != NULL) Disk.cow[lba >> 3] |= (uint8_t)(1u << (lba & 7));
+            if (offset < Disk.dirty_lo)                 Disk.dirty_lo = offset;
+            if (offset + DISK_SECTOR > Disk.dirty_hi)   Disk.dirty_hi = offset + DISK_SECTOR;
+            Disk.writes++;
+            break;
+
+        default:
+            DiskFlush(MS_ASYNC);
+            break;
+    }
+
+    Disk.status = DISK_DONE;
+    if (Disk.cmd & DISK_IRQ) IREQ_LINE(emu, DISK_IRQ_LINE)
+}
+
+static void DiskComplete(FemtoEmu_t *emu, void *arg)
+{
+    (void)arg;
+    DiskTransfer(emu);
+}
+
+static void DiskSetRegister(uint8_t port, uint8_t data)
+{
+    /* THE PENDING COMMAND USE ITS LATCHED COPY, BUT A WRITE WHILE BUSY IS A GUEST BUG */
+    if (Disk.status & DISK_BUSY)
+    {
+        Disk.status |= DISK_ERROR;
+        Disk.errors++;
+        return;
+    }
+
+    switch (port)
+    {
+        case DISK_LBA_PORT:      Disk.lba  = (Disk.lba & 0xFF00) | data;                          break;
+        case DISK_LBA_PORT + 1:  Disk.lba  = (uint16_t)((Disk.lba & 0x00FF) | (data << 8));       break;
+        case DISK_ADDR_PORT:     Disk.addr = (Disk.addr & 0x0F00) | data;                         break;
+        default:                 Disk.addr = (uint16_t)((Disk.addr & 0x00FF) | ((data & 0x0F) << 8)); break;
+    }
+}
+
+/* FALSE (AND ERROR STATUS) WHEN THE COMMAND CAN'T START */
+static bool DiskStart(uint8_t data)
+{
+    uint8_t cmd = data & 0x7F;
+
+    if ((Disk.status & DISK_BUSY) || cmd < DISK_READ || cmd > DISK_FLUSH ||
+        (cmd != DISK_FLUSH && (Disk.lba >= Disk.sectors || Disk.addr + DISK_SECTOR > 0x1000)))
+    {
+        Disk.status |= DISK_ERROR;
+        Disk.errors++;
+        return false;
+    }
+
+    Disk.cmd      = data;
+    Disk.run_lba  = Disk.lba;
+    Disk.run_addr = Disk.addr;
+    Disk.status   = DISK_BUSY;
+    return true;
+}
+
+/* DEVICE THREAD OF THE THREADED DISK: THE TRANSFER IS DONE AS SOON AS THE COMMAND IS RECEIVED */
+static void DiskDeviceWrite(FemtoDevice_t *dev, uint8_t port, uint8_t data)
+{
+    if (port != DISK_CMD_PORT)
+    {
+        DiskSetRegister(port, data);
+        return;
+    }
+
+    if (DiskStart(data))
+    {
+        DeviceSet(dev, DISK_CMD_PORT, Disk.status);
+        DiskTransfer(dev->emu);
+    }
+    DeviceSet(dev, DISK_CMD_PORT, Disk.status);
+}
+/*** END OF HELPING FUNCTIONS ***/
+
+
+/*** IO CALLBACKS ***/
+static OUTFUNC(DiskRegister, data)
+{
+    DiskSetRegister(IOPort(), data);
+}
+
+static OUTFUNC(DiskCommand, data)
+{
+    if (!DiskStart(data)) return;
+    EventAdd(Disk.emu, Disk.emu->cycles + DISK_SEEK_CYCLES + (((data & 0x7F) == DISK_FLUSH) ? 0 : DISK_SECTOR / DISK_BYTES_PER_CYCLE), DiskComplete, NULL);
+}
+
+static INPFUNC(DiskStatus)
+{
+    return Disk.status;
+}
+/*** END OF IO CALLBACKS ***/
+
+
+/* MUST BE CALLED AFTER IOInit() (EmuInit); overlay CAN BE NULL */
+void DiskOpen(FemtoEmu_t *emu, const char *image, const char *overlay, bool threaded, bool verbose)
+{
+    Disk      = (FemtoDisk_t){0};
+    Disk.emu  = emu;
+    Disk.base = DiskMap(image, overlay == NULL, false, 0, &Disk.size);
+
+    /* A PARTIAL LAST SECTOR IS NOT ADDRESSABLE, THE SECTOR NUMBER IS 16BITS */
+    Disk.sectors = (uint32_t)((Disk.size / DISK_SECTOR > 0x10000) ? 0x10000 : Disk.size / DISK_SECTOR);
+    Disk.map_over = Disk.size;
+
+    if (overlay != NULL)
+    {
+        Disk.over = DiskMap(overlay, true, true, Disk.size + ((Disk.sectors + 7) / 8), &Disk.map_over);
+        Disk.cow  = Disk.over + Disk.size;
+    }
+    Disk.dirty_lo = Disk.map_over;
+
+    if (threaded == true)
+    {
+        Disk.dev = DeviceCreate(emu, "DISK", DISK_LBA_PORT, DISK_CMD_PORT - DISK_LBA_PORT + 1, DiskDeviceWrite, NULL, NULL, verbose);
+    }
+    else
+    {
+        for (uint8_t port = DISK_LBA_PORT; port < DISK_CMD_PORT; port++)
+        {
+            RegisterOutputFunc(DiskRegister, port);
+        }
+        RegisterOutputFunc(DiskCommand, DISK_CMD_PORT);
+        RegisterInputFunc(DiskStatus, DISK_CMD_PORT);
+        IOPollable(DISK_CMD_PORT);
+    }
+
+    if (verbose == true) printf("DISK: \"%s\", %u SECTORS%s%s\n", image, Disk.sectors, (overlay != NULL) ? ", OVERLAY " : "", (overlay != NULL) ? overlay : "");
+}
+
+
+void DiskReport(void)
+{
+    if (Disk.dev != NULL) DeviceReport(Disk.dev);
+    printf("DISK: %llu SECTORS READ, %llu WRITTEN, %llu FLUSHES, %llu ERRORS\n", (unsigned long long)Disk.reads,
+           (unsigned long long)Disk.writes, (unsigned long long)Disk.flushes, (unsigned long long)Disk.errors);
+}
+
+
+void DiskQuit(void)
+{
+    /* THE DEVICE THREAD FINISH THE POSTED COMMANDS BEFORE THE IMAGE IS UNMAPPED */
+    if (Disk.dev != NULL) DeviceQuit(Disk.dev);
+    DiskFlush(MS_SYNC);
+    if (Disk.over != NULL) munmap(Disk.over, Disk.map_over);
+    munmap(Disk.base, Disk.size);
+    Disk = (FemtoDisk_t){0};
+}
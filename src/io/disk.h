@@ -0,0 +1,80 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+/* BLOCK STORAGE DEVICE:
+ * - A HOST IMAGE FILE OF DISK_SECTOR BYTES SECTORS, MAPPED IN THE HOST MEMORY (mmap), SO A SECTOR
+ *   TRANSFER IS A SINGLE memcpy BETWEEN THE GUEST RAM AND THE PAGE CACHE; THE IMAGE MUST EXIST, ONLY
+ *   THE OVERLAY IS CREATED
+ * - OUT DISK_LBA_PORT / +1  : SECTOR NUMBER, LOW BYTE THEN HIGH BYTE
+ * - OUT DISK_ADDR_PORT / +1 : RAM ADDRESS OF THE SECTOR BUFFER, LOW BYTE THEN HIGH 4 BITS
+ * - OUT DISK_CMD_PORT       : DISK_READ, DISK_WRITE OR DISK_FLUSH, + DISK_IRQ TO RAISE DISK_IRQ_LINE
+ *                             ON COMPLETION
+ * - IN  DISK_CMD_PORT       : STATUS, BIT 0 BUSY, BIT 1 DONE, BIT 2 ERROR (SECTOR OR BUFFER OUT OF RANGE)
+ * - THE COMMAND LATCH THE SECTOR NUMBER & THE ADDRESS; A REGISTER WRITE WHILE BUSY IS IGNORED & SET
+ *   THE ERROR BIT
+ * - A COMMAND COMPLETE DISK_SEEK_CYCLES + DISK_SECTOR / DISK_BYTES_PER_CYCLE GUEST CYCLES LATER
+ * - THE WRITTEN HOST PAGES ARE FLUSHED ASYNCHRONOUSLY (msync MS_ASYNC) BY DISK_FLUSH, AND
+ *   SYNCHRONOUSLY WHEN THE EMULATOR QUIT
+ * - WITH AN OVERLAY, THE BASE IMAGE IS ONLY READ (MANY INSTANCES CAN SHARE IT): A WRITTEN SECTOR
+ *   GO TO THE OVERLAY FILE (SAME SIZE AS THE IMAGE, SPARSE) AND ITS BIT IS SET IN THE BITMAP
+ *   STORED AFTER THEM, A READ TAKE THE SECTOR FROM THE OVERLAY WHEN ITS BIT IS SET
+ * - THREADED (device.h), THE REGISTERS AND COMMANDS ARE POSTED TO THE DEVICE THREAD, WHICH DO THE
+ *   TRANSFER AS SOON AS IT RECEIVE THE COMMAND; THE CPU KEEP RUNNING AND ONLY WAIT ON AN IN OF THE
+ *   STATUS POSTED AFTER A COMMAND NOT YET RECEIVED
+ */
+
+#ifndef DISK_H_
+#define DISK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../femto.h"
+
+#define DISK_LBA_PORT         0xC0
+#define DISK_ADDR_PORT        0xC2
+#define DISK_CMD_PORT         0xC4
+
+#define DISK_READ             0x01
+#define DISK_WRITE            0x02
+#define DISK_FLUSH            0x03
+#define DISK_IRQ              0x80
+
+#define DISK_BUSY             0x01
+#define DISK_DONE             0x02
+#define DISK_ERROR            0x04
+
+#define DISK_SECTOR           256     /* BYTES, A RAM PAGE */
+#define DISK_IRQ_LINE         5       /* LINE OF THE INTERRUPT CONTROLLER */
+#define DISK_SEEK_CYCLES      64
+#define DISK_BYTES_PER_CYCLE  4
+
+
+void DiskOpen(FemtoEmu_t *emu, const char *image, const char *overlay, bool threaded, bool verbose);
+void DiskReport(void);
+void DiskQuit(void);
+
+#endif
@@ -0,0 +1,198 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "dma.h"
+#include "io.h"
+#include "../cpu/cpu.h"
+#include "../cpu/event.h"
+#include "../cpu/int.h"
+
+
+typedef struct FemtoDma
+{
+    FemtoEmu_t *emu;
+    uint16_t    src;       /* RAM ADDRESS, OR IN PORT IN DEVICE MODE */
+    uint16_t    dst;
+    uint16_t    len;       /* 0 = 4096 */
+    uint8_t     ctrl;
+    uint8_t     status;
+    uint16_t    done;      /* BYTES ALREADY READ FROM THE DEVICE */
+    uint16_t    run_src;   /* REGISTERS LATCHED BY THE START, THE ONLY ONES USED BY THE TRANSFER */
+    uint16_t    run_dst;
+    uint32_t    run_len;
+    uint64_t    transfers;
+    uint64_t    bytes;
+    uint64_t    errors;
+} FemtoDma_t;
+
+
+/* THE IO CALLBACKS ARE GLOBAL, SO THERE IS ONLY ONE DMA CONTROLLER AT A TIME */
+static FemtoDma_t Dma;
+
+
+/*** HELPING FUNCTIONS ***/
+static uint32_t DmaLength(void)
+{
+    return (Dma.len == 0) ? 0x1000 : Dma.len;
+}
+
+static void DmaComplete(FemtoEmu_t *emu)
+{
+    Dma.status = (Dma.status & DMA_ERROR) | DMA_DONE;   /* A REGISTER WRITE WHILE BUSY STAY REPORTED */
+    Dma.transfers++;
+    if (Dma.ctrl & DMA_IRQ) IREQ_LINE(emu, DMA_IRQ_LINE)
+}
+
+static void DmaTransfer(FemtoEmu_t *emu, void *arg)
+{
+    uint32_t len      = Dma.run_len;
+    bool     cpu_wait = WAIT;   /* THE IN/OUT OF THE LAST INSTRUCTION MAY BE BLOCKED TOO */
+
+    (void)arg;
+
+    if ((Dma.ctrl & DMA_DEVICE) == 0)
+    {
+        memmove(RAM + Dma.run_dst, RAM + Dma.run_src, len);
+    }
+    else
+    {
+        /* THE DEVICE IS READ AS BY A SEQUENCE OF IN, ON BEHALF OF THE MACHINE */
+        WAIT = false;
+        while (Dma.done < len)
+        {
+            uint8_t data = In((uint8_t)Dma.run_src);
+
+            if (WAIT)
+            {
+                /* NO DATA YET, THE REST OF THE TRANSFER IS RETRIED LATER */
+                WAIT = cpu_wait;
+                EventAdd(emu, CYCLES + DMA_RETRY_CYCLES, DmaTransfer, NULL);
+                return;
+            }
+            RAM[Dma.run_dst + Dma.done] = data;
+            Dma.done++;
+        }
+        WAIT = cpu_wait;
+    }
+
+    /* THE FUZZER RESTORE THE DIRTY PAGES ONLY: EVERY PAGE WRITTEN MUST BE MARKED */
+    for (uint32_t a = Dma.run_dst & ~(PAGE_SIZE - 1); a < Dma.run_dst + len; a += PAGE_SIZE)
+    {
+        MARK_DIRTY(a)
+    }
+
+    Dma.bytes += len;
+    DmaComplete(emu);
+}
+/*** END OF HELPING FUNCTIONS ***/
+
+
+/*** IO CALLBACKS ***/
+static OUTFUNC(DmaRegister, data)
+{
+    uint16_t *reg  = NULL;
+    uint8_t   port = IOPort();
+
+    /* THE RUNNING TRANSFER USE ITS LATCHED COPY, BUT A WRITE WHILE BUSY IS A GUEST BUG */
+    if (Dma.status & DMA_BUSY)
+    {
+        Dma.status |= DMA_ERROR;
+        Dma.errors++;
+        return;
+    }
+
+    switch (port & 0xFE)
+    {
+        case DMA_SRC_PORT: reg = &Dma.src; break;
+        case DMA_DST_PORT: reg = &Dma.dst; break;
+        default:           reg = &Dma.len; break;
+    }
+
+    if ((port & 0x01) == 0) *reg = (*reg & 0x0F00) | data;
+    else                    *reg = (uint16_t)((*reg & 0x00FF) | ((data & 0x0F) << 8));
+}
+
+static OUTFUNC(DmaControl, data)
+{
+    FemtoEmu_t *emu = Dma.emu;
+    uint32_t    len = DmaLength();
+
+    if (Dma.status & DMA_BUSY)
+    {
+        Dma.status |= DMA_ERROR;
+        Dma.errors++;
+        return;
+    }
+
+    Dma.ctrl = data;
+    Dma.done = 0;
+    if (Dma.dst + len > 0x1000 || ((data & DMA_DEVICE) == 0 && Dma.src + len > 0x1000))
+    {
+        Dma.status = DMA_ERROR;
+        Dma.errors++;
+        return;
+    }
+
+    Dma.run_src = Dma.src;
+    Dma.run_dst = Dma.dst;
+    Dma.run_len = len;
+    Dma.status  = DMA_BUSY;
+    EventAdd(emu, CYCLES + DMA_SETUP_CYCLES + (len / DMA_BYTES_PER_CYCLE), DmaTransfer, NULL);
+}
+
+static INPFUNC(DmaStatus)
+{
+    return Dma.status;
+}
+/*** END OF IO CALLBACKS ***/
+
+
+/* MUST BE CALLED AFTER IOInit() (EmuInit) */
+void DmaInit(FemtoEmu_t *emu, bool verbose)
+{
+    Dma     = (FemtoDma_t){0};
+    Dma.emu = emu;
+
+    for (uint8_t port = DMA_SRC_PORT; port < DMA_CTRL_PORT; port++)
+    {
+        RegisterOutputFunc(DmaRegister, port);
+    }
+    RegisterOutputFunc(DmaControl, DMA_CTRL_PORT);
+    RegisterInputFunc(DmaStatus, DMA_CTRL_PORT);
+    IOPollable(DMA_CTRL_PORT);
+
+    if (verbose == true) printf("DMA: PORTS 0x%02X - 0x%02X\n", DMA_SRC_PORT, DMA_CTRL_PORT);
+}
+
+
+void DmaReport(void)
+{
+    printf("DMA: %llu TRANSFERS, %llu BYTES, %llu ERRORS\n",
+           (unsigned long long)Dma.transfers, (unsigned long long)Dma.bytes, (unsigned long long)Dma.errors);
+}
@@ -0,0 +1,70 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+/* DMA CONTROLLER:
+ * - OUT DMA_SRC_PORT / +1     : SOURCE ADDRESS, LOW BYTE THEN HIGH 4 BITS (DEVICE MODE: THE IN PORT)
+ * - OUT DMA_DST_PORT / +1     : DESTINATION ADDRESS, LOW BYTE THEN HIGH 4 BITS
+ * - OUT DMA_LEN_PORT / +1     : LENGTH IN BYTES, LOW BYTE THEN HIGH 4 BITS (0 = 4096)
+ * - OUT DMA_CTRL_PORT         : START THE TRANSFER; BIT 0 DEVICE TO RAM (ELSE RAM TO RAM),
+ *                               BIT 7 RAISE DMA_IRQ_LINE ON COMPLETION
+ * - IN  DMA_CTRL_PORT         : STATUS, BIT 0 BUSY, BIT 1 DONE, BIT 2 ERROR (BOTH CLEARED BY THE NEXT START)
+ * - THE TRANSFER TAKE DMA_SETUP_CYCLES + LENGTH / DMA_BYTES_PER_CYCLE GUEST CYCLES, THE CPU RUN
+ *   MEANWHILE; THE RAM IS WRITTEN AT ONCE (memmove) WHEN IT COMPLETE
+ * - A RANGE CROSSING THE END OF THE RAM, OR A START WHILE BUSY, IS AN ERROR: NOTHING IS COPIED
+ * - THE START LATCH SRC, DST & LEN; A REGISTER WRITE WHILE BUSY IS IGNORED & SET THE ERROR BIT
+ * - A DEVICE WITH NO DATA (IOWait) PAUSE THE TRANSFER, IT RESUME DMA_RETRY_CYCLES LATER
+ */
+
+#ifndef DMA_H_
+#define DMA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../femto.h"
+
+#define DMA_SRC_PORT         0xD0
+#define DMA_DST_PORT         0xD2
+#define DMA_LEN_PORT         0xD4
+#define DMA_CTRL_PORT        0xD6
+
+#define DMA_DEVICE           0x01
+#define DMA_IRQ              0x80
+
+#define DMA_BUSY             0x01
+#define DMA_DONE             0x02
+#define DMA_ERROR            0x04
+
+#define DMA_IRQ_LINE         4       /* LINE OF THE INTERRUPT CONTROLLER */
+#define DMA_SETUP_CYCLES     8
+#define DMA_BYTES_PER_CYCLE  4
+#define DMA_RETRY_CYCLES     64
+
+
+void DmaInit(FemtoEmu_t *emu, bool verbose);
+void DmaReport(void);
+
+#endif
@@ -0,0 +1,437 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "fb.h"
+#include "io.h"
+#include "../cpu/event.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FB_X86
+#endif
+
+#define FB_WORDS  ((FB_HEIGHT + 63) / 64)   /* 1 BIT PER SCANLINE */
+
+
+typedef void (*FbExpandFunc)(uint32_t *rgb, const uint8_t *idx, const uint8_t pal[3][16], int n);
+
+typedef struct FemtoFb
+{
+    /* CPU THREAD */
+    FemtoEmu_t     *emu;
+    uint8_t         vram[FB_HEIGHT][FB_WIDTH];
+    uint8_t         pal[3][16];            /* RED, GREEN & BLUE OF EACH ENTRY */
+    uint64_t        dirty[FB_WORDS];
+    bool            pal_dirty;
+    uint8_t         x;
+    uint8_t         y;
+    uint8_t         sel;                   /* PALETTE ENTRY */
+    uint8_t         comp;                  /* NEXT COMPONENT OF THE ENTRY */
+    uint8_t         frame;
+    uint64_t        deadline;              /* CYCLE OF THE NEXT FRAME */
+    uint64_t        frames;
+    uint64_t        merged;                /* FRAMES READY WHILE THE EXPORT THREAD WAS BUSY */
+
+    /* HAND-OFF, UNDER lock */
+    pthread_mutex_t lock;
+    pthread_cond_t  ready;
+    uint8_t         front[FB_HEIGHT][FB_WIDTH];
+    uint8_t         front_pal[3][16];
+    uint64_t        front_dirty[FB_WORDS];
+    bool            pending;
+    bool            quit;
+
+    /* EXPORT THREAD */
+    pthread_t       thread;
+    uint8_t         work[FB_HEIGHT][FB_WIDTH] __attribute__((aligned(16)));
+    uint8_t         work_pal[3][16] __attribute__((aligned(16)));
+    uint32_t        rgb[FB_HEIGHT][FB_WIDTH] __attribute__((aligned(16)));
+    const char     *ppm;                   /* PREFIX OF THE PPM FILES (NULL : NONE) */
+    FbShm_t        *shm;                   /* NULL : NONE */
+    size_t          shm_size;
+    uint64_t        exported;
+    uint64_t        lines;                 /* SCANLINES CONVERTED TO RGB */
+} FemtoFb_t;
+
+
+/* THE IO CALLBACKS ARE GLOBAL, SO THERE IS ONLY ONE FRAMEBUFFER AT A TIME */
+static FemtoFb_t *Fb = NULL;
+
+/* 16 COLORS OF THE CGA */
+static const uint8_t FbDefaultPal[3][16] =
+{
+    { 0x00, 0x00, 0x00, 0x00, 0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55, 0xFF, 0xFF, 0xFF, 0xFF },
+    { 0x00, 0x00, 0xAA, 0xAA, 0x00, 0x00, 0x55, 0xAA, 0x55, 0x55, 0xFF, 0xFF, 0x55, 0x55, 0xFF, 0xFF },
+    { 0x00, 0xAA, 0x00, 0xAA, 0x00, 0xAA, 0x00, 0xAA, 0x55, 0xFF, 0x55, 0xFF, 0x55, 0xFF, 0x55, 0xFF }
+};
+
+
+/*** PALETTE EXPANSION KERNELS: n PIXELS OF 4BITS TO 0x00RRGGBB ***/
+static void FbExpandGeneric(uint32_t *rgb, const uint8_t *idx, const uint8_t pal[3][16], int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        uint8_t p = idx[i] & 0x0F;
+
+        rgb[i] = ((uint32_t)pal[0][p] << 16) | ((uint32_t)pal[1][p] << 8) | pal[2][p];
+    }
+}
+
+#ifdef FB_X86
+/* THE PALETTE COMPONENTS ARE 16 BYTES TABLES: ONE pshufb LOOK UP 16 PIXELS */
+__attribute__((target("ssse3")))
+static void FbExpandSsse3(uint32_t *rgb, const uint8_t *idx, const uint8_t pal[3][16], int n)
+{
+    const __m128i red   = _mm_loadu_si128((const __m128i *)pal[0]);
+    const __m128i green = _mm_loadu_si128((const __m128i *)pal[1]);
+    const __m128i blue  = _mm_loadu_si128((const __m128i *)pal[2]);
+    const __m128i low   = _mm_set1_epi8(0x0F);
+    const __m128i zero  = _mm_setzero_si128();
+
+    for (int i = 0; i < n; i += 16)
+    {
+        __m128i p = _mm_and_si128(_mm_loadu_si128((const __m128i *)(idx + i)), low);
+        __m128i r = _mm_shuffle_epi8(red, p);
+        __m128i g = _mm_shuffle_epi8(green, p);
+        __m128i b = _mm_shuffle_epi8(blue, p);
+
+        /* INTERLEAVE TO B, G, R, 0 BYTES = 0x00RRGGBB LITTLE-ENDIAN */
+        __m128i bg_lo = _mm_unpacklo_epi8(b, g);
+        __m128i bg_hi = _mm_unpackhi_epi8(b, g);
+        __m128i r_lo  = _mm_unpacklo_epi8(r, zero);
+        __m128i r_hi  = _mm_unpackhi_epi8(r, zero);
+
+        _mm_storeu_si128((__m128i *)(rgb + i),      _mm_unpacklo_epi16(bg_lo, r_lo));
+        _mm_storeu_si128((__m128i *)(rgb + i + 4),  _mm_unpackhi_epi16(bg_lo, r_lo));
+        _mm_storeu_si128((__m128i *)(rgb + i + 8),  _mm_unpacklo_epi16(bg_hi, r_hi));
+        _mm_storeu_si128((__m128i *)(rgb + i + 12), _mm_unpackhi_epi16(bg_hi, r_hi));
+    }
+}
+#endif
+
+static FbExpandFunc FbExpand     = FbExpandGeneric;
+static const char  *FbExpandName = "GENERIC";
+/*** END OF PALETTE EXPANSION KERNELS ***/
+
+
+/*** HELPING FUNCTIONS ***/
+static bool FbLineDirty(const uint64_t *dirty, int y)
+{
+    return (dirty[y >> 6] >> (y & 63)) & 1;
+}
+
+static void FbWritePpm(void)
+{
+    char     path[4096];
+    uint8_t  line[FB_WIDTH * 3];
+    FILE    *out = NULL;
+
+    snprintf(path, sizeof(path), "%s%06llu.ppm", Fb->ppm, (unsigned long long)Fb->exported);
+    out = fopen(path, "wb");
+    if (out == NULL)
+    {
+        printf("ERROR (FbWritePpm): CAN'T CREATE FILE \"%s\" !!!\n", path);
+        return;
+    }
+
+    fprintf(out, "P6\n%d %d\n255\n", FB_WIDTH, FB_HEIGHT);
+    for (int y = 0; y < FB_HEIGHT; y++)
+    {
+        for (int x = 0; x < FB_WIDTH; x++)
+        {
+            line[(x * 3)]     = (uint8_t)(Fb->rgb[y][x] >> 16);
+            line[(x * 3) + 1] = (uint8_t)(Fb->rgb[y][x] >> 8);
+            line[(x * 3) + 2] = (uint8_t)(Fb->rgb[y][x]);
+        }
+        fwrite(line, 1, sizeof(line), out);
+    }
+    fclose(out);
+}
+
+static void * FbThread(void *arg)
+{
+    uint64_t dirty[FB_WORDS];
+
+    (void)arg;
+    while (true)
+    {
+        /* TAKE THE DIRTY SCANLINES OF THE LAST FRAME(S) */
+        pthread_mutex_lock(&Fb->lock);
+        while (!Fb->pending && !Fb->quit) pthread_cond_wait(&Fb->ready, &Fb->lock);
+        if (!Fb->pending)
+        {
+            pthread_mutex_unlock(&Fb->lock);
+            break;
+        }
+        for (int y = 0; y < FB_HEIGHT; y++)
+        {
+            if (FbLineDirty(Fb->front_dirty, y)) memcpy(Fb->work[y], Fb->front[y], FB_WIDTH);
+        }
+        memcpy(Fb->work_pal, Fb->front_pal, sizeof(Fb->work_pal));
+        memcpy(dirty, Fb->front_dirty, sizeof(dirty));
+        memset(Fb->front_dirty, 0, sizeof(Fb->front_dirty));
+        Fb->pending = false;
+        pthread_mutex_unlock(&Fb->lock);
+
+        /* CONVERT ONLY THEM */
+        for (int y = 0; y < FB_HEIGHT; y++)
+        {
+            if (!FbLineDirty(dirty, y)) continue;
+            FbExpand(Fb->rgb[y], Fb->work[y], (const uint8_t (*)[16])Fb->work_pal, FB_WIDTH);
+            Fb->lines++;
+        }
+
+        if (Fb->shm != NULL)
+        {
+            uint32_t *pixels = (uint32_t *)(Fb->shm + 1);
+
+            __atomic_fetch_add(&Fb->shm->seq, 1, __ATOMIC_ACQ_REL);
+            for (int y = 0; y < FB_HEIGHT; y++)
+            {
+                if (FbLineDirty(dirty, y)) memcpy(pixels + (y * FB_WIDTH), Fb->rgb[y], FB_WIDTH * sizeof(uint32_t));
+            }
+            __atomic_fetch_add(&Fb->shm->seq, 1, __ATOMIC_RELEASE);
+        }
+        if (Fb->ppm != NULL) FbWritePpm();
+        Fb->exported++;
+    }
+    return NULL;
+}
+
+/* GIVE THE DIRTY SCANLINES TO THE EXPORT THREAD, A FEW memcpy UNDER THE LOCK */
+static void FbPublish(void)
+{
+    bool any = Fb->pal_dirty;
+
+    for (int w = 0; w < FB_WORDS; w++) any = any || (Fb->dirty[w] != 0);
+    if (!any) return;
+
+    /* A NEW PALETTE CHANGE THE COLOR OF EVERY SCANLINE */
+    if (Fb->pal_dirty) memset(Fb->dirty, 0xFF, sizeof(Fb->dirty));
+
+    pthread_mutex_lock(&Fb->lock);
+    if (Fb->pending) Fb->merged++;
+    for (int y = 0; y < FB_HEIGHT; y++)
+    {
+        if (FbLineDirty(Fb->dirty, y)) memcpy(Fb->front[y], Fb->vram[y], FB_WIDTH);
+    }
+    for (int w = 0; w < FB_WORDS; w++) Fb->front_dirty[w] |= Fb->dirty[w];
+    memcpy(Fb->front_pal, Fb->pal, sizeof(Fb->pal));
+    Fb->pending = true;
+    pthread_cond_signal(&Fb->ready);
+    pthread_mutex_unlock(&Fb->lock);
+
+    memset(Fb->dirty, 0, sizeof(Fb->dirty));
+    Fb->pal_dirty = false;
+}
+
+static void FbFrame(FemtoEmu_t *emu, void *arg)
+{
+    (void)arg;
+
+    Fb->frame++;
+    Fb->frames++;
+    FbPublish();
+
+    /* FROM THE DEADLINE, SO THE FRAME RATE NEVER DRIFT */
+    Fb->deadline += FB_FRAME_CYCLES;
+    EventAdd(emu, Fb->deadline, FbFrame, NULL);
+}
+
+static inline void FbPixel(uint8_t data)
+{
+    uint8_t pixel = data & 0x0F;
+
+    if (Fb->vram[Fb->y][Fb->x] != pixel)
+    {
+        Fb->vram[Fb->y][Fb->x] = pixel;
+        Fb->dirty[Fb->y >> 6] |= 1ULL << (Fb->y & 63);
+    }
+
+    if (++Fb->x == FB_WIDTH)
+    {
+        Fb->x = 0;
+        Fb->y = (Fb->y + 1) % FB_HEIGHT;
+    }
+}
+/*** END OF HELPING FUNCTIONS ***/
+
+
+/*** IO CALLBACKS ***/
+static OUTFUNC(FbX, data)
+{
+    Fb->x = data % FB_WIDTH;
+}
+
+static OUTFUNC(FbY, data)
+{
+    Fb->y = data % FB_HEIGHT;
+}
+
+static OUTFUNC(FbData, data)
+{
+    FbPixel(data);
+}
+
+/* A BLOCK OF PIXELS, WITHOUT A CALL PER OUT */
+static uint32_t FbDataBulk(FemtoEmu_t *emu, void *ctx, uint8_t io_port, const uint8_t *data, uint32_t len)
+{
+    (void)emu; (void)ctx; (void)io_port;
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        FbPixel(data[i]);
+    }
+    return len;
+}
+
+static OUTFUNC(FbPal, data)
+{
+    Fb->sel  = data & 0x0F;
+    Fb->comp = 0;
+}
+
+static OUTFUNC(FbRgb, data)
+{
+    Fb->pal[Fb->comp][Fb->sel] = data;
+    Fb->comp      = (Fb->comp + 1) % 3;
+    Fb->pal_dirty = true;
+}
+
+static INPFUNC(FbFrameCount)
+{
+    return Fb->frame;
+}
+/*** END OF IO CALLBACKS ***/
+
+
+/* MUST BE CALLED AFTER IOInit() (EmuInit); ppm (PREFIX OF THE FILES) & shm (NAME) CAN BE NULL */
+void FbInit(FemtoEmu_t *emu, const char *ppm, const char *shm, bool verbose)
+{
+    Fb = aligned_alloc(64, (sizeof(FemtoFb_t) + 63) & ~(size_t)63);
+    if (Fb == NULL)
+    {
+        printf("ERROR (FbInit): CAN'T ALLOCATE FRAMEBUFFER !!!\n");
+        exit(-1);
+    }
+    memset(Fb, 0, sizeof(FemtoFb_t));
+    Fb->emu = emu;
+    Fb->ppm = ppm;
+    memcpy(Fb->pal, FbDefaultPal, sizeof(Fb->pal));
+    pthread_mutex_init(&Fb->lock, NULL);
+    pthread_cond_init(&Fb->ready, NULL);
+
+    /* THE WHOLE (BLACK) SCREEN IS EXPORTED ONCE */
+    Fb->pal_dirty = true;
+
+#ifdef FB_X86
+    if (__builtin_cpu_supports("ssse3"))
+    {
+        FbExpand     = FbExpandSsse3;
+        FbExpandName = "SSSE3";
+    }
+#endif
+
+    if (shm != NULL)
+    {
+        int fd = shm_open(shm, O_CREAT | O_RDWR, 0644);
+
+        Fb->shm_size = sizeof(FbShm_t) + (FB_WIDTH * FB_HEIGHT * sizeof(uint32_t));
+        if (fd < 0 || ftruncate(fd, (off_t)Fb->shm_size) != 0)
+        {
+            printf("ERROR (FbInit): CAN'T CREATE SHARED MEMORY \"%s\" !!!\n", shm);
+            exit(-1);
+        }
+        Fb->shm = mmap(NULL, Fb->shm_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (Fb->shm == MAP_FAILED)
+        {
+            printf("ERROR (FbInit): CAN'T MAP SHARED MEMORY \"%s\" !!!\n", shm);
+            exit(-1);
+        }
+        Fb->shm->magic  = FB_SHM_MAGIC;
+        Fb->shm->width  = FB_WIDTH;
+        Fb->shm->height = FB_HEIGHT;
+        Fb->shm->seq    = 0;
+    }
+
+    RegisterOutputFunc(FbX, FB_X_PORT);
+    RegisterOutputFunc(FbY, FB_Y_PORT);
+    RegisterOutputFunc(FbData, FB_DATA_PORT);
+    IORegisterBulk(FB_DATA_PORT, FbDataBulk, NULL);
+    RegisterOutputFunc(FbPal, FB_PAL_PORT);
+    RegisterOutputFunc(FbRgb, FB_RGB_PORT);
+    RegisterInputFunc(FbFrameCount, FB_FRAME_PORT);
+    IOPollable(FB_FRAME_PORT);
+
+    if (pthread_create(&Fb->thread, NULL, FbThread, NULL) != 0)
+    {
+        printf("ERROR (FbInit): CAN'T CREATE THE EXPORT THREAD !!!\n");
+        exit(-1);
+    }
+    Fb->deadline = emu->cycles + FB_FRAME_CYCLES;
+    EventAdd(emu, Fb->deadline, FbFrame, NULL);
+
+    if (verbose == true) printf("FB: %dx%d, PORTS 0x%02X - 0x%02X, %s PALETTE EXPANSION\n", FB_WIDTH, FB_HEIGHT, FB_X_PORT, FB_FRAME_PORT, FbExpandName);
+}
+
+
+void FbReport(void)
+{
+    printf("FB: %llu FRAMES, %llu EXPORTED, %llu MERGED, %llu SCANLINES CONVERTED (%s)\n", (unsigned long long)Fb->frames,
+           (unsigned long long)Fb->exported, (unsigned long long)Fb->merged, (unsigned long long)Fb->lines, FbExpandName);
+}
+
+
+/* EXPORT THE LAST CHANGES, THEN STOP THE EXPORT THREAD */
+void FbStop(void)
+{
+    FbPublish();
+
+    pthread_mutex_lock(&Fb->lock);
+    Fb->quit = true;
+    pthread_cond_signal(&Fb->ready);
+    pthread_mutex_unlock(&Fb->lock);
+    pthread_join(Fb->thread, NULL);
+}
+
+
+void FbQuit(void)
+{
+    if (Fb->shm != NULL) munmap(Fb->shm, Fb->shm_size);
+    pthread_mutex_destroy(&Fb->lock);
+    pthread_cond_destroy(&Fb->ready);
+    free(Fb);
+    Fb = NULL;
+}
@@ -0,0 +1,78 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+/* FRAMEBUFFER:
+ * - FB_WIDTH x FB_HEIGHT PIXELS OF 4BITS (16 COLORS PALETTE), IN THE VIDEO RAM OF THE DEVICE
+ * - OUT FB_X_PORT / FB_Y_PORT : CURSOR POSITION
+ * - OUT FB_DATA_PORT          : PIXEL AT THE CURSOR, THE CURSOR MOVE RIGHT (THEN TO THE NEXT LINE)
+ * - OUT FB_PAL_PORT           : SELECT THE PALETTE ENTRY (LOW 4BITS)
+ * - OUT FB_RGB_PORT           : RED, GREEN THEN BLUE OF THE SELECTED ENTRY
+ * - IN  FB_FRAME_PORT         : FRAMES SINCE RESET (LOW 8BITS), TO SYNCHRONIZE ON THE VERTICAL BLANK
+ * - EACH WRITE MARK ITS SCANLINE DIRTY; EVERY FB_FRAME_CYCLES GUEST CYCLES, THE DIRTY SCANLINES ARE
+ *   COPIED FOR THE EXPORT THREAD, WHICH CONVERT ONLY THEM TO RGB (SSSE3 PALETTE LOOKUP, 16 PIXELS
+ *   PER pshufb) & WRITE THE FRAME AS A PPM FILE AND/OR IN A SHARED MEMORY BUFFER
+ * - A FRAME WITH NO CHANGE IS NOT EXPORTED; A FRAME READY WHILE THE EXPORT THREAD IS BUSY IS
+ *   MERGED WITH THE NEXT ONE, THE CPU THREAD NEVER WAIT FOR IT
+ * - SHARED MEMORY LAYOUT: FbShm_t HEADER, THEN FB_WIDTH x FB_HEIGHT PIXELS OF 32BITS (0x00RRGGBB);
+ *   seq IS ODD WHILE THE PIXELS ARE WRITTEN
+ */
+
+#ifndef FB_H_
+#define FB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../femto.h"
+
+#define FB_X_PORT        0xB0
+#define FB_Y_PORT        0xB1
+#define FB_DATA_PORT     0xB2
+#define FB_PAL_PORT      0xB3
+#define FB_RGB_PORT      0xB4
+#define FB_FRAME_PORT    0xB5
+
+#define FB_WIDTH         128     /* MULTIPLE OF 16 */
+#define FB_HEIGHT        96
+#define FB_FRAME_CYCLES  16666   /* 60 FRAMES PER SECOND AT 1MHz */
+#define FB_SHM_MAGIC     0x46424D46
+
+
+typedef struct FbShm
+{
+    uint32_t magic;
+    uint32_t width;
+    uint32_t height;
+    uint32_t seq;       /* INCREMENTED BEFORE & AFTER EACH FRAME UPDATE */
+} FbShm_t;
+
+
+void FbInit(FemtoEmu_t *emu, const char *ppm, const char *shm, bool verbose);
+void FbStop(void);
+void FbReport(void);
+void FbQuit(void);
+
+#endif
@@ -35,59 +35,252 @@
 typedef uint8_t (*InFunc)(void);
 typedef void    (*OutFunc)(uint8_t data);
 
+typedef struct IOPortEntry
+{
+    IOInFunc    in;
+    void       *in_ctx;
+    IOOutFunc   out;
+    void       *out_ctx;
+    IOBulkFunc  bulk;         /* NULL : EACH OUT CALL out */
+    void       *bulk_ctx;
+    bool        pollable;     /* IN WITHOUT SIDE EFFECT, A LOOP POLLING IT CAN BE FAST-FORWARDED (idle.c) */
+} IOPortEntry_t;
+
 
 /* DEFAULT INPUT & OUTPUT CALLBACKS TO PREVENT SEGMENTATION ERROR */
-OUTFUNC(OutDefault, data)
+static void IODefaultOut(FemtoEmu_t *emu, void *ctx, uint8_t io_port, uint8_t data)
 {
-    return;
+    (void)emu; (void)ctx; (void)io_port; (void)data;
 }
 
-INPFUNC(InDefault)
+static uint8_t IODefaultIn(FemtoEmu_t *emu, void *ctx, uint8_t io_port)
 {
+    (void)emu; (void)ctx; (void)io_port;
     return 0xFF;
 }
 
-InFunc  InputFunction[256]  = {NULL};
-OutFunc OutputFunction[256] = {NULL};
+static IOPortEntry_t IOTable[256] =
+{
+    [0 ... 255] = { IODefaultIn, NULL, IODefaultOut, NULL, NULL, NULL, true }
+};
+
+/* MACHINE CURRENTLY RUN BY THIS HOST THREAD, SO A CALLBACK SHARED BY MANY MACHINES KNOWS ITS CALLER */
+static __thread FemtoEmu_t *IOCurrentMachine = NULL;
+static __thread uint8_t     IOCurrentPort    = 0;
+
+/* OUT WAITING FOR THE BULK HANDLER OF IOBulkPort, WRITTEN BY IOBulkMachine */
+static __thread uint8_t     IOBulkBuf[IO_BULK_MAX];
+static __thread uint32_t    IOBulkLen     = 0;
+static __thread uint8_t     IOBulkPort    = 0;
+static __thread FemtoEmu_t *IOBulkMachine = NULL;
+static __thread bool        IOWaiting     = false;   /* SET BY IOWait, SO IOFlush KNOWS THE OUT WAS NOT TAKEN */
+
+
+/*** HELPING FUNCTIONS ***/
+/* THE UNTYPED CALLBACK IS THE CONTEXT OF THESE ADAPTERS */
+static uint8_t IOUntypedIn(FemtoEmu_t *emu, void *ctx, uint8_t io_port)
+{
+    (void)emu; (void)io_port;
+    return ((InFunc)ctx)();
+}
+
+static void IOUntypedOut(FemtoEmu_t *emu, void *ctx, uint8_t io_port, uint8_t data)
+{
+    (void)emu; (void)io_port;
+    ((OutFunc)ctx)(data);
+}
+/*** END OF HELPING FUNCTIONS ***/
 
 
 void IOInit(bool verbose)
 {
     if (verbose == true) printf("IO: STARTING INITIALIZATION\n");
 
+    /* THE BYTES LEFT BELONG TO A PREVIOUS MACHINE, ITS HANDLERS ARE GONE */
+    IOBulkLen     = 0;
+    IOBulkMachine = NULL;
     for (int i = 0; i < 256; i++)
     {
-        RegisterInputFunc(InDefault, i);
-        RegisterOutputFunc(OutDefault, i);
+        IOTable[i] = (IOPortEntry_t){ IODefaultIn, NULL, IODefaultOut, NULL, NULL, NULL, true };
     }
 
     if (verbose == true) printf("IO: INITIALIZATION SUCCESSFUL\n");
 }
 
 
+void IORegisterIn(uint8_t io_port, IOInFunc func, void *ctx)
+{
+    IOTable[io_port].in       = func;
+    IOTable[io_port].in_ctx   = ctx;
+    IOTable[io_port].pollable = false;
+}
+
+
+/* ALSO REMOVE THE BULK HANDLER OF io_port */
+void IORegisterOut(uint8_t io_port, IOOutFunc func, void *ctx)
+{
+    IOTable[io_port].out      = func;
+    IOTable[io_port].out_ctx  = ctx;
+    IOTable[io_port].bulk     = NULL;
+    IOTable[io_port].bulk_ctx = NULL;
+}
+
+
+/* THE OUT HANDLER STAY REGISTERED, BUT IS NO MORE CALLED WHILE A BULK HANDLER IS */
+void IORegisterBulk(uint8_t io_port, IOBulkFunc func, void *ctx)
+{
+    IOTable[io_port].bulk     = func;
+    IOTable[io_port].bulk_ctx = ctx;
+}
+
+
+/* HAND THE BUFFERED OUT TO THEIR BULK HANDLER, FALSE WHEN SOME ARE LEFT */
+bool IOFlush(void)
+{
+    IOPortEntry_t *entry  = &IOTable[IOBulkPort];
+    FemtoEmu_t    *caller = IOCurrentMachine;
+    uint32_t       done   = 0;
+
+    if (IOBulkLen == 0) return true;
+
+    /* THE BULK HANDLER WAS REMOVED (IORegisterOut) SINCE THE BYTES WERE BUFFERED, ONE OUT EACH ON
+     * BEHALF OF THEIR MACHINE, UP TO THE 1ST ONE THE OUT HANDLER CAN'T TAKE (IOWait)
+     */
+    if (entry->bulk == NULL)
+    {
+        IOCurrentMachine = IOBulkMachine;
+        IOCurrentPort    = IOBulkPort;
+        for (done = 0; done < IOBulkLen; done++)
+        {
+            IOWaiting = false;
+            entry->out(IOBulkMachine, entry->out_ctx, IOBulkPort, IOBulkBuf[done]);
+            if (IOWaiting) break;
+        }
+        IOCurrentMachine = caller;
+    }
+    else
+    {
+        done = entry->bulk(IOBulkMachine, entry->bulk_ctx, IOBulkPort, IOBulkBuf, IOBulkLen);
+    }
+
+    if (done < IOBulkLen)
+    {
+        for (uint32_t i = done; i < IOBulkLen; i++)
+        {
+            IOBulkBuf[i - done] = IOBulkBuf[i];
+        }
+    }
+    IOBulkLen -= done;
+    return IOBulkLen == 0;
+}
+
+
+/* EmuStep CALL IOFlush (THEN EventRun, WHICH RECOMPUTE next_event) WHEN cycles REACH next_event */
+void IOFlushDeadline(FemtoEmu_t *emu)
+{
+    if (emu != NULL && emu->next_event > emu->cycles + IO_BULK_CYCLES) emu->next_event = emu->cycles + IO_BULK_CYCLES;
+}
+
+
 void RegisterInputFunc(void *func, uint8_t io_port)
 {
-    InputFunction[io_port] = func;
-    // DEBUG:
-    printf("DEBUG ==> RegisterInputFunc() : REGISTER func %p to INPUT PORT  0x%02X\n", func, io_port);
+    IORegisterIn(io_port, IOUntypedIn, func);
+}
+
+
+/* THE INPUT CALLBACK OF io_port ONLY READ A DEVICE STATE, WHICH ONLY CHANGE ON AN EVENT OR BY A HOST THREAD */
+void IOPollable(uint8_t io_port)
+{
+    IOTable[io_port].pollable = true;
+}
+
+
+bool IOIsPollable(uint8_t io_port)
+{
+    return IOTable[io_port].pollable;
 }
 
 
 void RegisterOutputFunc(void *func, uint8_t io_port)
 {
-    OutputFunction[io_port] = func;
-    // DEBUG:
-    printf("DEBUG ==> RegisterOutputFunc(): REGISTER func %p to OUTPUT PORT 0x%02X\n", func, io_port);
+    IORegisterOut(io_port, IOUntypedOut, func);
 }
 
 
 uint8_t In(uint8_t io_port)
 {
-    return (*InputFunction[io_port])();
+    /* THE DEVICE MAY DEPEND ON THE BUFFERED OUT */
+    if (IOBulkLen > 0 && !IOFlush())
+    {
+        IOWait();
+        return 0xFF;
+    }
+
+    IOCurrentPort = io_port;
+    return IOTable[io_port].in(IOCurrentMachine, IOTable[io_port].in_ctx, io_port);
 }
 
 
 void Out(uint8_t data, uint8_t io_port)
 {
-    (*OutputFunction[io_port])(data);
-}
\ No newline at end of file
+    if (IOTable[io_port].bulk != NULL)
+    {
+        /* ANOTHER PORT OR MACHINE: HAND OVER ALL THE BUFFERED BYTES FIRST; FULL BUFFER: MAKE ROOM */
+        if (IOBulkLen > 0 && (IOBulkPort != io_port || IOBulkMachine != IOCurrentMachine))
+        {
+            if (!IOFlush())
+            {
+                IOWait();
+                return;
+            }
+        }
+        else if (IOBulkLen == IO_BULK_MAX)
+        {
+            IOFlush();
+            if (IOBulkLen == IO_BULK_MAX)
+            {
+                IOWait();
+                return;
+            }
+        }
+        if (IOBulkLen == 0) IOFlushDeadline(IOCurrentMachine);
+        IOBulkPort              = io_port;
+        IOBulkMachine           = IOCurrentMachine;
+        IOBulkBuf[IOBulkLen++]  = data;
+        return;
+    }
+
+    if (IOBulkLen > 0 && !IOFlush())
+    {
+        IOWait();
+        return;
+    }
+
+    IOCurrentPort = io_port;
+    IOTable[io_port].out(IOCurrentMachine, IOTable[io_port].out_ctx, io_port, data);
+}
+
+
+void IOBind(FemtoEmu_t *emu)
+{
+    IOCurrentMachine = emu;
+}
+
+
+FemtoEmu_t * IOMachine(void)
+{
+    return IOCurrentMachine;
+}
+
+
+uint8_t IOPort(void)
+{
+    return IOCurrentPort;
+}
+
+
+void IOWait(void)
+{
+    IOWaiting = true;
+    if (IOCurrentMachine != NULL) IOCurrentMachine->wait = true;
+}
@@ -29,16 +29,51 @@
 #define IO_H_
 
 #include <stdint.h>
+#include <stdbool.h>
+#include "../femto.h"
 
 
 #define INPFUNC(n)      uint8_t n(void)
 #define OUTFUNC(n, d)   void    n(uint8_t d)
 
+#define IO_BULK_MAX     256     /* OUT BUFFERED FOR A BULK HANDLER */
+#define IO_BULK_CYCLES  1024    /* LONGEST DELAY OF A BUFFERED OUT, IN GUEST CYCLES */
+
+/* TYPED CALLBACKS: emu IS THE MACHINE DOING THE IN/OUT, ctx IS GIVEN AT THE REGISTRATION */
+typedef uint8_t  (*IOInFunc)(FemtoEmu_t *emu, void *ctx, uint8_t io_port);
+typedef void     (*IOOutFunc)(FemtoEmu_t *emu, void *ctx, uint8_t io_port, uint8_t data);
+
+/* BULK HANDLER: RECEIVE THE BYTES OF CONSECUTIVE OUT TO THE SAME PORT, RETURN HOW MANY IT TOOK.
+ * THE OUT ARE BUFFERED (UP TO IO_BULK_MAX) AND HANDED OVER WHEN THE BUFFER IS FULL, ON AN IN/OUT
+ * TO ANOTHER PORT, BEFORE THE DEVICES EVENTS AND WHEN THE MACHINE STOPS (IOFlush); WHILE THE
+ * BYTES LEFT CAN'T BE HANDED OVER, THE NEXT IN/OUT IS RETRIED (IOWait)
+ * THE 1ST BUFFERED OUT LOWER next_event TO IO_BULK_CYCLES LATER (IOFlushDeadline), SO EmuStep HAND
+ * THEM OVER EVEN IF THE GUEST DO NO MORE IN/OUT
+ */
+typedef uint32_t (*IOBulkFunc)(FemtoEmu_t *emu, void *ctx, uint8_t io_port, const uint8_t *data, uint32_t len);
+
 void    IOInit(bool verbose);
+void    IORegisterIn(uint8_t io_port, IOInFunc func, void *ctx);
+void    IORegisterOut(uint8_t io_port, IOOutFunc func, void *ctx);
+void    IORegisterBulk(uint8_t io_port, IOBulkFunc func, void *ctx);
+bool    IOFlush(void);
+void    IOFlushDeadline(FemtoEmu_t *emu);
+
+/* UNTYPED CALLBACKS (INPFUNC / OUTFUNC), THEY FIND THEIR STATE WITH IOMachine() & IOPort() */
 void    RegisterInputFunc(void *func, uint8_t io_port);
 void    RegisterOutputFunc(void *func, uint8_t io_port);
+void    IOPollable(uint8_t io_port);
+bool    IOIsPollable(uint8_t io_port);
 uint8_t In(uint8_t io_port);
 void    Out(uint8_t data, uint8_t io_port);
 
+/* MACHINE ON WHICH BEHALF THE CALLBACKS ARE CALLED (PER HOST THREAD) */
+void         IOBind(FemtoEmu_t *emu);
+FemtoEmu_t * IOMachine(void);
+uint8_t      IOPort(void);      /* PORT OF THE IN/OUT BEING SERVED */
+
+/* CALLED BY A CALLBACK WITH NO DATA TO GIVE (OR TAKE), THE IN/OUT IS RETRIED WHEN THE CPU IS RESUMED */
+void         IOWait(void);
+
 
 #endif
\ No newline at end of file
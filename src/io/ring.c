@@ -0,0 +1,268 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/uio.h>
+#include "ring.h"
+#include "io.h"
+
+
+typedef struct IORing
+{
+    /* PRODUCER & CONSUMER INDEXES ARE FREE RUNNING, ON THEIR OWN CACHE LINE */
+    uint32_t  head __attribute__((aligned(64)));   /* WRITTEN BY THE CPU THREAD */
+    uint32_t  tail __attribute__((aligned(64)));   /* WRITTEN BY THE DRAIN THREAD */
+    uint8_t   buf[IORING_SIZE] __attribute__((aligned(64)));
+
+    int       fd;
+    int       policy;
+    uint64_t  written;   /* BYTES WRITTEN TO fd */
+    uint64_t  dropped;   /* BYTES LOST, RING FULL (IORING_DROP) */
+    uint64_t  blocked;   /* OUT RETRIED, RING FULL (IORING_BLOCK) */
+} IORing_t;
+
+
+static IORing_t  *Ring[256]   = {NULL};
+static pthread_t  RingThread;
+static bool       RingRunning = false;
+static bool       RingStop    = false;
+
+
+/*** IO CALLBACKS OF THE BUFFERED PORTS ***/
+static void IORingOut(FemtoEmu_t *emu, void *ctx, uint8_t io_port, uint8_t data)
+{
+    IORing_t *ring = ctx;
+    uint32_t  head = ring->head;
+
+    (void)emu; (void)io_port;
+
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) == IORING_SIZE)
+    {
+        if (ring->policy == IORING_BLOCK)
+        {
+            ring->blocked++;
+            IOWait();
+        }
+        else
+        {
+            ring->dropped++;
+        }
+        return;
+    }
+
+    ring->buf[head & (IORING_SIZE - 1)] = data;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+/* A BLOCK OF OUT: AT MOST 2 memcpy AND A SINGLE PUBLICATION OF head */
+static uint32_t IORingBulk(FemtoEmu_t *emu, void *ctx, uint8_t io_port, const uint8_t *data, uint32_t len)
+{
+    IORing_t *ring  = ctx;
+    uint32_t  head  = ring->head;
+    uint32_t  room  = IORING_SIZE - (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE));
+    uint32_t  n     = (len < room) ? len : room;
+    uint32_t  start = head & (IORING_SIZE - 1);
+    uint32_t  first = (n < IORING_SIZE - start) ? n : IORING_SIZE - start;
+
+    (void)emu; (void)io_port;
+
+    memcpy(ring->buf + start, data, first);
+    memcpy(ring->buf, data + first, n - first);
+    __atomic_store_n(&ring->head, head + n, __ATOMIC_RELEASE);
+
+    if (n == len) return len;
+    if (ring->policy == IORING_BLOCK)
+    {
+        ring->blocked++;
+        return n;
+    }
+    ring->dropped += len - n;
+    return len;
+}
+/*** END OF IO CALLBACKS ***/
+
+
+/*** HELPING FUNCTIONS ***/
+/* WRITE ALL THE PENDING BYTES OF A RING, RETURN THE NUMBER OF BYTES WRITTEN */
+static uint32_t IORingDrain(IORing_t *ring)
+{
+    uint32_t     tail  = ring->tail;
+    uint32_t     count = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - tail;
+    uint32_t     start = tail & (IORING_SIZE - 1);
+    struct iovec iov[2];
+    int          iovcnt = 1;
+    ssize_t      n      = 0;
+
+    if (count == 0) return 0;
+
+    /* THE PENDING BYTES MAY WRAP AROUND THE END OF THE RING: 2 PARTS, 1 SYSCALL */
+    iov[0].iov_base = ring->buf + start;
+    iov[0].iov_len  = count;
+    if (start + count > IORING_SIZE)
+    {
+        iov[0].iov_len  = IORING_SIZE - start;
+        iov[1].iov_base = ring->buf;
+        iov[1].iov_len  = count - iov[0].iov_len;
+        iovcnt          = 2;
+    }
+
+    /* A BROKEN OUTPUT MUST NOT BLOCK THE GUEST FOREVER, ITS BYTES ARE SKIPPED */
+    n = writev(ring->fd, iov, iovcnt);
+    if (n > 0) ring->written += (uint64_t)n;
+    else       n = count;
+
+    __atomic_store_n(&ring->tail, tail + (uint32_t)n, __ATOMIC_RELEASE);
+    return (uint32_t)n;
+}
+
+static void * IORingThread(void *arg)
+{
+    const struct timespec idle = { 0, 100000 };   /* 100us */
+    bool                  stop = false;
+
+    (void)arg;
+    while (true)
+    {
+        uint32_t drained = 0;
+
+        /* READ THE STOP FLAG BEFORE THE LAST PASS, SO NO BYTE OUT BEFORE IORingStop() IS LOST */
+        stop = __atomic_load_n(&RingStop, __ATOMIC_ACQUIRE);
+        for (int p = 0; p < 256; p++)
+        {
+            if (Ring[p] != NULL) drained += IORingDrain(Ring[p]);
+        }
+
+        if (stop && drained == 0) break;
+        if (drained == 0) nanosleep(&idle, NULL);
+    }
+
+    return NULL;
+}
+/*** END OF HELPING FUNCTIONS ***/
+
+
+int IORingParsePolicy(const char *policy)
+{
+    if (strcmp(policy, "drop") == 0)  return IORING_DROP;
+    if (strcmp(policy, "block") == 0) return IORING_BLOCK;
+
+    printf("ERROR (IORingParsePolicy): UNKNOWN POLICY \"%s\" (drop | block) !!!\n", policy);
+    exit(-1);
+}
+
+
+/* MUST BE CALLED AFTER IOInit() (EmuInit), BEFORE IORingStart() */
+void IORingOpen(uint8_t io_port, const char *path, int policy, bool verbose)
+{
+    IORing_t *ring = NULL;
+
+    if (Ring[io_port] != NULL)
+    {
+        printf("ERROR (IORingOpen): PORT 0x%02X IS ALREADY BUFFERED !!!\n", io_port);
+        exit(-1);
+    }
+
+    ring = aligned_alloc(64, sizeof(IORing_t));
+    if (ring == NULL)
+    {
+        printf("ERROR (IORingOpen): CAN'T ALLOCATE RING FOR PORT 0x%02X !!!\n", io_port);
+        exit(-1);
+    }
+    memset(ring, 0, sizeof(IORing_t));
+    ring->policy = policy;
+
+    ring->fd = (strcmp(path, "-") == 0) ? STDOUT_FILENO : open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (ring->fd < 0)
+    {
+        printf("ERROR (IORingOpen): CAN'T OPEN FILE \"%s\" !!!\n", path);
+        exit(-1);
+    }
+
+    Ring[io_port] = ring;
+    IORegisterOut(io_port, IORingOut, ring);
+    IORegisterBulk(io_port, IORingBulk, ring);
+    if (verbose == true) printf("IORING: PORT 0x%02X BUFFERED TO \"%s\" (%s)\n", io_port, path, (policy == IORING_BLOCK) ? "BLOCK" : "DROP");
+}
+
+
+void IORingStart(void)
+{
+    if (RingRunning) return;
+
+    RingStop = false;
+    if (pthread_create(&RingThread, NULL, IORingThread, NULL) != 0)
+    {
+        printf("ERROR (IORingStart): CAN'T CREATE THE DRAIN THREAD !!!\n");
+        exit(-1);
+    }
+    RingRunning = true;
+}
+
+
+/* FLUSH EVERY RING & JOIN THE DRAIN THREAD */
+void IORingStop(void)
+{
+    if (!RingRunning) return;
+
+    __atomic_store_n(&RingStop, true, __ATOMIC_RELEASE);
+    pthread_join(RingThread, NULL);
+    RingRunning = false;
+
+    for (int p = 0; p < 256; p++)
+    {
+        if (Ring[p] != NULL && Ring[p]->fd != STDOUT_FILENO) close(Ring[p]->fd);
+        if (Ring[p] != NULL) Ring[p]->fd = -1;
+    }
+}
+
+
+void IORingReport(void)
+{
+    for (int p = 0; p < 256; p++)
+    {
+        if (Ring[p] == NULL) continue;
+        printf("IORING: PORT 0x%02X: %llu BYTES WRITTEN, %llu DROPPED, %llu BLOCKED\n", p, (unsigned long long)Ring[p]->written,
+               (unsigned long long)Ring[p]->dropped, (unsigned long long)Ring[p]->blocked);
+    }
+}
+
+
+void IORingQuit(void)
+{
+    IORingStop();
+    for (int p = 0; p < 256; p++)
+    {
+        free(Ring[p]);
+        Ring[p] = NULL;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+/* BUFFERED OUTPUT PORTS:
+ * - AN OUT TO A BUFFERED PORT ONLY STORE THE BYTE IN A LOCK-FREE SINGLE PRODUCER / SINGLE CONSUMER
+ *   RING (THE CPU THREAD IS THE PRODUCER), SO A SLOW FILE OR TERMINAL NEVER STALL THE EMULATION
+ * - ONE HOST THREAD DRAIN ALL THE RINGS, EACH ONE WITH A SINGLE writev() OF ALL ITS PENDING BYTES
+ * - RING FULL (BACKPRESSURE): IORING_DROP LOSE THE BYTE, IORING_BLOCK RETRY THE OUT LATER (IOWait),
+ *   BOTH ARE COUNTED PER PORT
+ * - CONSECUTIVE OUT TO A BUFFERED PORT ARE COPIED IN THE RING AS A BLOCK (IO BULK HANDLER)
+ * - ONLY ONE HOST THREAD MAY OUT TO A GIVEN BUFFERED PORT
+ */
+
+#ifndef RING_H_
+#define RING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define IORING_SIZE   4096    /* BYTES PER RING, POWER OF 2 */
+#define IORING_DROP   0
+#define IORING_BLOCK  1
+
+
+int  IORingParsePolicy(const char *policy);
+void IORingOpen(uint8_t io_port, const char *path, int policy, bool verbose);
+void IORingStart(void);
+void IORingStop(void);
+void IORingReport(void);
+void IORingQuit(void);
+
+#endif
\ No newline at end of file
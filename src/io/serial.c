@@ -0,0 +1,281 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+#define _GNU_SOURCE   /* posix_openpt, ptsname, cfmakeraw */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <termios.h>
+#include <pthread.h>
+#include "serial.h"
+#include "io.h"
+#include "../cpu/int.h"
+
+
+typedef struct SerialFifo
+{
+    /* PRODUCER & CONSUMER INDEXES ARE FREE RUNNING, ON THEIR OWN CACHE LINE */
+    uint32_t head __attribute__((aligned(64)));
+    uint32_t tail __attribute__((aligned(64)));
+    uint8_t  buf[SERIAL_FIFO] __attribute__((aligned(64)));
+} SerialFifo_t;
+
+typedef struct FemtoSerial
+{
+    SerialFifo_t  tx;          /* CPU THREAD -> HELPER THREAD */
+    SerialFifo_t  rx;          /* HELPER THREAD -> CPU THREAD */
+    FemtoEmu_t   *emu;
+    int           master;
+    int           slave;       /* KEPT OPEN, SO THE MASTER DOES NOT HANG UP WITHOUT CLIENT */
+    char          path[64];
+    uint8_t       ctrl;
+    bool          quit;
+    pthread_t     thread;
+    uint64_t      sent;
+    uint64_t      received;
+    uint64_t      writes;      /* HOST write() */
+    uint64_t      reads;       /* HOST read() */
+} FemtoSerial_t;
+
+
+/* THE IO CALLBACKS ARE GLOBAL, SO THERE IS ONLY ONE SERIAL CONSOLE AT A TIME */
+static FemtoSerial_t *Serial = NULL;
+
+
+/*** HELPER THREAD ***/
+/* ONE write() FOR THE CONTIGUOUS BYTES OF THE TX FIFO */
+static void SerialFlush(void)
+{
+    uint32_t tail  = Serial->tx.tail;
+    uint32_t count = __atomic_load_n(&Serial->tx.head, __ATOMIC_ACQUIRE) - tail;
+    uint32_t start = tail & (SERIAL_FIFO - 1);
+    ssize_t  n     = 0;
+
+    if (count == 0) return;
+    if (count > SERIAL_FIFO - start) count = SERIAL_FIFO - start;
+
+    n = write(Serial->master, Serial->tx.buf + start, count);
+    Serial->writes++;
+    if (n <= 0) return;
+
+    Serial->sent += (uint64_t)n;
+    __atomic_store_n(&Serial->tx.tail, tail + (uint32_t)n, __ATOMIC_RELEASE);
+}
+
+/* ONE read() FOR THE CONTIGUOUS ROOM OF THE RX FIFO */
+static void SerialFill(void)
+{
+    uint32_t head  = Serial->rx.head;
+    uint32_t room  = SERIAL_FIFO - (head - __atomic_load_n(&Serial->rx.tail, __ATOMIC_ACQUIRE));
+    uint32_t start = head & (SERIAL_FIFO - 1);
+    bool     empty = false;
+    ssize_t  n     = 0;
+
+    if (room == 0) return;
+    if (room > SERIAL_FIFO - start) room = SERIAL_FIFO - start;
+
+    n = read(Serial->master, Serial->rx.buf + start, room);
+    Serial->reads++;
+    if (n <= 0) return;
+
+    empty = (head == __atomic_load_n(&Serial->rx.tail, __ATOMIC_ACQUIRE));
+    Serial->received += (uint64_t)n;
+    __atomic_store_n(&Serial->rx.head, head + (uint32_t)n, __ATOMIC_RELEASE);
+    if (empty && (__atomic_load_n(&Serial->ctrl, __ATOMIC_RELAXED) & SERIAL_RX_IRQ)) IREQ_LINE(Serial->emu, SERIAL_IRQ_LINE)
+}
+
+static void * SerialThread(void *arg)
+{
+    int drain = SERIAL_DRAIN_POLLS;
+
+    (void)arg;
+    while (true)
+    {
+        bool          quit  = __atomic_load_n(&Serial->quit, __ATOMIC_ACQUIRE);
+        bool          tx    = __atomic_load_n(&Serial->tx.head, __ATOMIC_ACQUIRE) != Serial->tx.tail;
+        bool          room  = (Serial->rx.head - __atomic_load_n(&Serial->rx.tail, __ATOMIC_ACQUIRE)) < SERIAL_FIFO;
+        struct pollfd pfd   = { Serial->master, 0, 0 };
+
+        /* AT THE END, THE TX FIFO IS FLUSHED UNLESS NOBODY READ THE PTY */
+        if (quit && (!tx || drain-- == 0)) break;
+
+        /* A FULL RX FIFO IS NOT READ: THE PTY BUFFER THROTTLE THE CLIENT */
+        if (room) pfd.events |= POLLIN;
+        if (tx)   pfd.events |= POLLOUT;
+
+        /* THE TIMEOUT BOUND THE DELAY OF THE BYTES ENQUEUED BY THE CPU MEANWHILE */
+        if (poll(&pfd, 1, SERIAL_POLL_MS) <= 0) continue;
+        if (pfd.revents & POLLOUT) SerialFlush();
+        if (pfd.revents & POLLIN)  SerialFill();
+    }
+    return NULL;
+}
+/*** END OF HELPER THREAD ***/
+
+
+/*** IO CALLBACKS ***/
+static OUTFUNC(SerialTx, data)
+{
+    uint32_t head = Serial->tx.head;
+
+    if (head - __atomic_load_n(&Serial->tx.tail, __ATOMIC_ACQUIRE) == SERIAL_FIFO)
+    {
+        IOWait();
+        return;
+    }
+    Serial->tx.buf[head & (SERIAL_FIFO - 1)] = data;
+    __atomic_store_n(&Serial->tx.head, head + 1, __ATOMIC_RELEASE);
+}
+
+/* A BLOCK OF OUT: AT MOST 2 memcpy AND A SINGLE PUBLICATION OF head */
+static uint32_t SerialTxBulk(FemtoEmu_t *emu, void *ctx, uint8_t io_port, const uint8_t *data, uint32_t len)
+{
+    uint32_t head  = Serial->tx.head;
+    uint32_t room  = SERIAL_FIFO - (head - __atomic_load_n(&Serial->tx.tail, __ATOMIC_ACQUIRE));
+    uint32_t n     = (len < room) ? len : room;
+    uint32_t start = head & (SERIAL_FIFO - 1);
+    uint32_t first = (n < SERIAL_FIFO - start) ? n : SERIAL_FIFO - start;
+
+    (void)emu; (void)ctx; (void)io_port;
+
+    memcpy(Serial->tx.buf + start, data, first);
+    memcpy(Serial->tx.buf, data + first, n - first);
+    __atomic_store_n(&Serial->tx.head, head + n, __ATOMIC_RELEASE);
+    return n;
+}
+
+static INPFUNC(SerialRx)
+{
+    uint32_t tail = Serial->rx.tail;
+    uint8_t  data = 0;
+
+    if (__atomic_load_n(&Serial->rx.head, __ATOMIC_ACQUIRE) == tail)
+    {
+        IOWait();
+        return 0xFF;
+    }
+    data = Serial->rx.buf[tail & (SERIAL_FIFO - 1)];
+    __atomic_store_n(&Serial->rx.tail, tail + 1, __ATOMIC_RELEASE);
+    return data;
+}
+
+static INPFUNC(SerialStatus)
+{
+    uint32_t tx     = Serial->tx.head - __atomic_load_n(&Serial->tx.tail, __ATOMIC_ACQUIRE);
+    uint8_t  status = 0;
+
+    if (__atomic_load_n(&Serial->rx.head, __ATOMIC_ACQUIRE) != Serial->rx.tail) status |= SERIAL_RX_AVAIL;
+    if (tx == SERIAL_FIFO) status |= SERIAL_TX_FULL;
+    if (tx == 0)           status |= SERIAL_TX_EMPTY;
+    return status;
+}
+
+static OUTFUNC(SerialControl, data)
+{
+    __atomic_store_n(&Serial->ctrl, data, __ATOMIC_RELAXED);
+}
+/*** END OF IO CALLBACKS ***/
+
+
+/* MUST BE CALLED AFTER IOInit() (EmuInit) */
+void SerialInit(FemtoEmu_t *emu, bool verbose)
+{
+    struct termios raw;
+    const char    *name = NULL;
+
+    Serial = aligned_alloc(64, (sizeof(FemtoSerial_t) + 63) & ~(size_t)63);
+    if (Serial == NULL)
+    {
+        printf("ERROR (SerialInit): CAN'T ALLOCATE SERIAL CONSOLE !!!\n");
+        exit(-1);
+    }
+    memset(Serial, 0, sizeof(FemtoSerial_t));
+    Serial->emu = emu;
+
+    Serial->master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (Serial->master < 0 || grantpt(Serial->master) != 0 || unlockpt(Serial->master) != 0 || (name = ptsname(Serial->master)) == NULL)
+    {
+        printf("ERROR (SerialInit): CAN'T CREATE THE PSEUDO-TERMINAL !!!\n");
+        exit(-1);
+    }
+    snprintf(Serial->path, sizeof(Serial->path), "%s", name);
+
+    /* RAW: NO ECHO, NO LINE EDITING, NO CR/LF TRANSLATION */
+    Serial->slave = open(Serial->path, O_RDWR | O_NOCTTY);
+    if (Serial->slave < 0 || tcgetattr(Serial->slave, &raw) != 0)
+    {
+        printf("ERROR (SerialInit): CAN'T OPEN \"%s\" !!!\n", Serial->path);
+        exit(-1);
+    }
+    cfmakeraw(&raw);
+    tcsetattr(Serial->slave, TCSANOW, &raw);
+
+    RegisterOutputFunc(SerialTx, SERIAL_DATA_PORT);
+    IORegisterBulk(SERIAL_DATA_PORT, SerialTxBulk, NULL);
+    RegisterInputFunc(SerialRx, SERIAL_DATA_PORT);
+    RegisterInputFunc(SerialStatus, SERIAL_STAT_PORT);
+    IOPollable(SERIAL_STAT_PORT);
+    RegisterOutputFunc(SerialControl, SERIAL_CTRL_PORT);
+
+    if (pthread_create(&Serial->thread, NULL, SerialThread, NULL) != 0)
+    {
+        printf("ERROR (SerialInit): CAN'T CREATE THE HELPER THREAD !!!\n");
+        exit(-1);
+    }
+
+    /* ALWAYS PRINTED, THE USER HAS TO CONNECT TO IT */
+    printf("SERIAL: CONSOLE ON %s\n", Serial->path);
+    fflush(stdout);
+    if (verbose == true) printf("SERIAL: PORTS 0x%02X - 0x%02X, RX IRQ ON LINE %d\n", SERIAL_DATA_PORT, SERIAL_CTRL_PORT, SERIAL_IRQ_LINE);
+}
+
+
+/* TRANSMIT THE BYTES LEFT IN THE TX FIFO, THEN STOP THE HELPER THREAD */
+void SerialStop(void)
+{
+    __atomic_store_n(&Serial->quit, true, __ATOMIC_RELEASE);
+    pthread_join(Serial->thread, NULL);
+}
+
+
+void SerialReport(void)
+{
+    printf("SERIAL: %llu BYTES SENT IN %llu WRITES, %llu BYTES RECEIVED IN %llu READS\n", (unsigned long long)Serial->sent,
+           (unsigned long long)Serial->writes, (unsigned long long)Serial->received, (unsigned long long)Serial->reads);
+}
+
+
+void SerialQuit(void)
+{
+    close(Serial->slave);
+    close(Serial->master);
+    free(Serial);
+    Serial = NULL;
+}
@@ -0,0 +1,66 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+/* SERIAL CONSOLE ON A HOST PSEUDO-TERMINAL:
+ * - THE SLAVE (PRINTED AT START, EX: /dev/pts/3) IS IN RAW MODE, CONNECT TO IT WITH screen, minicom, ...
+ * - OUT SERIAL_DATA_PORT : BYTE TO TRANSMIT, TX FIFO FULL: THE OUT IS RETRIED (IOWait)
+ * - IN  SERIAL_DATA_PORT : BYTE RECEIVED, RX FIFO EMPTY: THE IN IS RETRIED (IOWait)
+ * - IN  SERIAL_STAT_PORT : BIT 0 RX DATA AVAILABLE, BIT 1 TX FIFO FULL, BIT 2 TX FIFO EMPTY
+ * - OUT SERIAL_CTRL_PORT : BIT 0 RAISE SERIAL_IRQ_LINE WHEN DATA ARRIVE IN THE EMPTY RX FIFO
+ * - THE FIFOS ARE LOCK-FREE SINGLE PRODUCER / SINGLE CONSUMER RINGS; A HELPER THREAD poll() THE
+ *   MASTER OF THE PTY AND MOVE WHOLE BATCHES (ONE read() OR write() FOR ALL THE BYTES READY), SO A
+ *   GUEST PRINTING TEXT NEVER PAY A SYSCALL PER OUT
+ */
+
+#ifndef SERIAL_H_
+#define SERIAL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../femto.h"
+
+#define SERIAL_DATA_PORT  0x80
+#define SERIAL_STAT_PORT  0x81
+#define SERIAL_CTRL_PORT  0x82
+
+#define SERIAL_RX_AVAIL   0x01
+#define SERIAL_TX_FULL    0x02
+#define SERIAL_TX_EMPTY   0x04
+#define SERIAL_RX_IRQ     0x01
+
+#define SERIAL_IRQ_LINE   7          /* LINE OF THE INTERRUPT CONTROLLER */
+#define SERIAL_FIFO       4096       /* BYTES PER FIFO, POWER OF 2 */
+#define SERIAL_POLL_MS    2          /* LONGEST DELAY OF A BYTE IN THE TX FIFO */
+#define SERIAL_DRAIN_POLLS 100       /* POLLS TO FLUSH THE TX FIFO WHEN THE EMULATOR QUIT */
+
+
+void SerialInit(FemtoEmu_t *emu, bool verbose);
+void SerialStop(void);
+void SerialReport(void);
+void SerialQuit(void);
+
+#endif
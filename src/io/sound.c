@@ -0,0 +1,311 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "sound.h"
+#include "io.h"
+#include "../cpu/event.h"
+
+
+typedef struct SoundWrite
+{
+    uint64_t cycle;
+    uint8_t  reg;
+    uint8_t  data;
+} SoundWrite_t;
+
+typedef struct FemtoSound
+{
+    /* PRODUCER & CONSUMER INDEXES ARE FREE RUNNING, ON THEIR OWN CACHE LINE */
+    uint32_t      head __attribute__((aligned(64)));   /* WRITTEN BY THE CPU THREAD */
+    uint64_t      now;                                 /* LAST GUEST CYCLE PUBLISHED */
+    bool          quit;
+    uint32_t      tail __attribute__((aligned(64)));   /* WRITTEN BY THE SYNTHESIS THREAD */
+    SoundWrite_t  queue[SOUND_QUEUE];
+
+    /* CPU THREAD */
+    FemtoEmu_t   *emu;
+    uint8_t       sel;
+    uint64_t      tick;          /* GUEST CYCLES BETWEEN TWO PUBLICATIONS */
+    uint64_t      deadline;
+    uint64_t      writes;
+    uint64_t      blocked;
+
+    /* SYNTHESIS THREAD */
+    pthread_t     thread;
+    FILE         *out;
+    uint64_t      cpu_hz;
+    uint8_t       regs[SOUND_REGS];
+    uint32_t      phase[4];      /* 32BITS FIXED POINT, ONE PERIOD = 2^32 */
+    uint32_t      step[4];
+    uint16_t      lfsr;
+    uint64_t      samples;
+    int16_t       buf[SOUND_BLOCK];
+    double        busy;          /* HOST SECONDS SPENT RENDERING */
+} FemtoSound_t;
+
+
+/* THE IO CALLBACKS ARE GLOBAL, SO THERE IS ONLY ONE SOUND CHIP AT A TIME */
+static FemtoSound_t *Sound = NULL;
+
+/* AMPLITUDE OF EACH VOLUME, 2dB STEPS, 4 CHANNELS AT 15 DO NOT CLIP */
+static const int16_t SoundLevel[16] =
+{
+    0, 326, 411, 517, 651, 819, 1031, 1298, 1634, 2057, 2590, 3261, 4105, 5168, 6506, 8191
+};
+
+
+/*** HELPING FUNCTIONS (SYNTHESIS THREAD) ***/
+static double SoundClock(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+/* x * num / den WITHOUT OVERFLOW OF x * num */
+static uint64_t SoundScale(uint64_t x, uint64_t num, uint64_t den)
+{
+    return ((x / den) * num) + (((x % den) * num) / den);
+}
+
+static void SoundPut32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+
+/* MONO 16BITS PCM; SIZES ARE PATCHED BY SoundQuit WHEN THE OUTPUT IS A FILE */
+static void SoundWavHeader(uint32_t bytes)
+{
+    uint8_t h[44] = { 'R','I','F','F', 0,0,0,0, 'W','A','V','E', 'f','m','t',' ', 16,0,0,0, 1,0, 1,0,
+                      0,0,0,0, 0,0,0,0, 2,0, 16,0, 'd','a','t','a', 0,0,0,0 };
+
+    SoundPut32(h + 4, (bytes == UINT32_MAX) ? UINT32_MAX : bytes + 36);
+    SoundPut32(h + 24, SOUND_RATE);
+    SoundPut32(h + 28, SOUND_RATE * 2);
+    SoundPut32(h + 40, bytes);
+    fwrite(h, 1, sizeof(h), Sound->out);
+}
+
+/* PHASE INCREMENT PER SAMPLE OF A SQUARE WAVE OF cpu_hz / (32 x period) Hz */
+static uint32_t SoundStep(uint64_t period)
+{
+    if (period == 0) return 0;
+    return (uint32_t)((((double)Sound->cpu_hz / (32.0 * (double)period)) / SOUND_RATE) * 4294967296.0);
+}
+
+static void SoundApply(const SoundWrite_t *w)
+{
+    uint8_t *r = Sound->regs;
+
+    if (w->reg >= SOUND_REGS) return;
+    r[w->reg] = w->data;
+
+    for (int ch = 0; ch < 3; ch++)
+    {
+        Sound->step[ch] = SoundStep(((uint64_t)(r[(ch * 3) + 1] & 0x0F) << 8) | r[ch * 3]);
+    }
+    Sound->step[3] = SoundStep(16 * ((uint64_t)r[9] + 1));
+}
+
+static int16_t SoundSample(void)
+{
+    const uint8_t *r   = Sound->regs;
+    int            mix = 0;
+
+    for (int ch = 0; ch < 3; ch++)
+    {
+        int16_t level = SoundLevel[r[(ch * 3) + 2] & 0x0F];
+
+        Sound->phase[ch] += Sound->step[ch];
+        if (Sound->step[ch] != 0) mix += (Sound->phase[ch] & 0x80000000u) ? level : -level;
+    }
+
+    /* THE LFSR IS CLOCKED ON EACH WRAP OF THE NOISE PHASE */
+    if (Sound->phase[3] + Sound->step[3] < Sound->phase[3])
+    {
+        uint16_t bit = (uint16_t)((Sound->lfsr ^ (Sound->lfsr >> 1)) & 1);
+
+        Sound->lfsr = (uint16_t)((Sound->lfsr >> 1) | (bit << 14));
+    }
+    Sound->phase[3] += Sound->step[3];
+    mix += (Sound->lfsr & 1) ? SoundLevel[r[10] & 0x0F] : -SoundLevel[r[10] & 0x0F];
+
+    return (int16_t)mix;
+}
+
+static void * SoundThread(void *arg)
+{
+    const struct timespec nap = { 0, 1000000 };   /* 1ms */
+
+    (void)arg;
+    while (true)
+    {
+        bool     quit   = __atomic_load_n(&Sound->quit, __ATOMIC_ACQUIRE);   /* BEFORE now, SO now IS FINAL */
+        uint64_t target = SoundScale(__atomic_load_n(&Sound->now, __ATOMIC_ACQUIRE), SOUND_RATE, Sound->cpu_hz);
+        uint32_t n      = 0;
+        double   start  = 0.0;
+
+        if (Sound->samples >= target)
+        {
+            if (quit) break;
+            nanosleep(&nap, NULL);
+            continue;
+        }
+
+        start = SoundClock();
+        n     = (target - Sound->samples > SOUND_BLOCK) ? SOUND_BLOCK : (uint32_t)(target - Sound->samples);
+        for (uint32_t i = 0; i < n; i++)
+        {
+            uint64_t cycle = SoundScale(Sound->samples + i, Sound->cpu_hz, SOUND_RATE);
+            uint32_t head  = __atomic_load_n(&Sound->head, __ATOMIC_ACQUIRE);
+
+            /* THE REGISTER WRITES DONE BEFORE THIS SAMPLE */
+            while (Sound->tail != head && Sound->queue[Sound->tail & (SOUND_QUEUE - 1)].cycle <= cycle)
+            {
+                SoundApply(&Sound->queue[Sound->tail & (SOUND_QUEUE - 1)]);
+                __atomic_store_n(&Sound->tail, Sound->tail + 1, __ATOMIC_RELEASE);
+            }
+            Sound->buf[i] = SoundSample();
+        }
+        fwrite(Sound->buf, sizeof(int16_t), n, Sound->out);
+        Sound->samples += n;
+        Sound->busy    += SoundClock() - start;
+    }
+    return NULL;
+}
+/*** END OF HELPING FUNCTIONS ***/
+
+
+/*** CPU THREAD ***/
+static void SoundTick(FemtoEmu_t *emu, void *arg)
+{
+    (void)arg;
+
+    __atomic_store_n(&Sound->now, emu->cycles, __ATOMIC_RELEASE);
+    Sound->deadline += Sound->tick;
+    EventAdd(emu, Sound->deadline, SoundTick, NULL);
+}
+
+static OUTFUNC(SoundSelect, data)
+{
+    Sound->sel = data;
+}
+
+static OUTFUNC(SoundData, data)
+{
+    uint32_t head = Sound->head;
+
+    if (head - __atomic_load_n(&Sound->tail, __ATOMIC_ACQUIRE) == SOUND_QUEUE)
+    {
+        Sound->blocked++;
+        IOWait();
+        return;
+    }
+
+    Sound->queue[head & (SOUND_QUEUE - 1)] = (SoundWrite_t){ Sound->emu->cycles, Sound->sel, data };
+    __atomic_store_n(&Sound->head, head + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&Sound->now, Sound->emu->cycles, __ATOMIC_RELEASE);
+    Sound->writes++;
+}
+/*** END OF CPU THREAD ***/
+
+
+/* MUST BE CALLED AFTER IOInit() (EmuInit); cpu_hz CONVERT THE GUEST CYCLES TO SECONDS */
+void SoundInit(FemtoEmu_t *emu, const char *path, uint64_t cpu_hz, bool verbose)
+{
+    Sound = aligned_alloc(64, (sizeof(FemtoSound_t) + 63) & ~(size_t)63);
+    if (Sound == NULL)
+    {
+        printf("ERROR (SoundInit): CAN'T ALLOCATE SOUND CHIP !!!\n");
+        exit(-1);
+    }
+    memset(Sound, 0, sizeof(FemtoSound_t));
+    Sound->emu    = emu;
+    Sound->cpu_hz = (cpu_hz == 0) ? SOUND_CPU_HZ : cpu_hz;
+    Sound->lfsr   = 0x4000;
+    Sound->tick   = (Sound->cpu_hz / SOUND_TICK > 0) ? Sound->cpu_hz / SOUND_TICK : 1;
+    Sound->now    = emu->cycles;
+
+    Sound->out = fopen(path, "wb");
+    if (Sound->out == NULL)
+    {
+        printf("ERROR (SoundInit): CAN'T CREATE FILE \"%s\" !!!\n", path);
+        exit(-1);
+    }
+    /* THE SIZES ARE UNKNOWN UNTIL THE END, A PIPE KEEP THEM AT THEIR MAXIMUM */
+    SoundWavHeader(UINT32_MAX);
+
+    RegisterOutputFunc(SoundSelect, SOUND_REG_PORT);
+    RegisterOutputFunc(SoundData, SOUND_DATA_PORT);
+
+    if (pthread_create(&Sound->thread, NULL, SoundThread, NULL) != 0)
+    {
+        printf("ERROR (SoundInit): CAN'T CREATE THE SYNTHESIS THREAD !!!\n");
+        exit(-1);
+    }
+    Sound->deadline = emu->cycles + Sound->tick;
+    EventAdd(emu, Sound->deadline, SoundTick, NULL);
+
+    if (verbose == true) printf("SOUND: PORTS 0x%02X - 0x%02X, %d Hz TO \"%s\"\n", SOUND_REG_PORT, SOUND_DATA_PORT, SOUND_RATE, path);
+}
+
+
+/* RENDER UP TO THE LAST GUEST CYCLE, THEN STOP THE SYNTHESIS THREAD */
+void SoundStop(FemtoEmu_t *emu)
+{
+    __atomic_store_n(&Sound->now, emu->cycles, __ATOMIC_RELEASE);
+    __atomic_store_n(&Sound->quit, true, __ATOMIC_RELEASE);
+    pthread_join(Sound->thread, NULL);
+}
+
+
+void SoundReport(void)
+{
+    double audio = (double)Sound->samples / SOUND_RATE;
+
+    printf("SOUND: %llu REGISTER WRITES (%llu RETRIED), %.3f s OF AUDIO RENDERED IN %.3f s (%.0fx REAL TIME)\n",
+           (unsigned long long)Sound->writes, (unsigned long long)Sound->blocked, audio, Sound->busy,
+           (Sound->busy > 0.0) ? audio / Sound->busy : 0.0);
+}
+
+
+void SoundQuit(void)
+{
+    uint64_t bytes = Sound->samples * sizeof(int16_t);
+
+    /* PATCH THE SIZES OF THE HEADER, WHEN THE OUTPUT CAN SEEK */
+    if (bytes < UINT32_MAX - 36 && fseek(Sound->out, 0, SEEK_SET) == 0) SoundWavHeader((uint32_t)bytes);
+    fclose(Sound->out);
+    free(Sound);
+    Sound = NULL;
+}
@@ -0,0 +1,68 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+/* SOUND CHIP:
+ * - 3 SQUARE WAVE CHANNELS & 1 NOISE CHANNEL (15BITS LFSR), 16 VOLUMES (2dB STEPS, 15 = MAX)
+ * - OUT SOUND_REG_PORT  : SELECT A REGISTER
+ * - OUT SOUND_DATA_PORT : WRITE THE SELECTED REGISTER
+ *     REGISTERS 0, 3, 6 : PERIOD OF THE TONE n, LOW BYTE
+ *     REGISTERS 1, 4, 7 : PERIOD OF THE TONE n, HIGH 4BITS (FREQUENCY = CPU CLOCK / (32 x PERIOD))
+ *     REGISTERS 2, 5, 8 : VOLUME OF THE TONE n
+ *     REGISTER  9       : PERIOD OF THE NOISE (FREQUENCY = CPU CLOCK / (32 x 16 x (PERIOD + 1)))
+ *     REGISTER  10      : VOLUME OF THE NOISE
+ * - A WRITE IS ONLY ENQUEUED, WITH ITS GUEST CYCLE, IN A SINGLE PRODUCER / SINGLE CONSUMER RING;
+ *   THE SYNTHESIS THREAD APPLY IT AT THE SAMPLE OF THIS CYCLE, AND RENDER BLOCKS OF
+ *   SOUND_BLOCK SAMPLES (MONO, 16BITS, SOUND_RATE Hz) TO A WAV FILE OR A PIPE
+ * - THE GUEST TIME IS PUBLISHED EVERY SOUND_TICK OF A SECOND, SO THE THREAD RENDER THE
+ *   SILENCES AND THE NOTES HELD WITHOUT WRITE TOO
+ * - RING FULL: THE OUT IS RETRIED (IOWait)
+ */
+
+#ifndef SOUND_H_
+#define SOUND_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../femto.h"
+
+#define SOUND_REG_PORT   0xA0
+#define SOUND_DATA_PORT  0xA1
+
+#define SOUND_REGS       11
+#define SOUND_RATE       44100
+#define SOUND_BLOCK      4096       /* SAMPLES PER WRITE */
+#define SOUND_QUEUE      4096       /* REGISTER WRITES, POWER OF 2 */
+#define SOUND_TICK       100        /* GUEST TIME PUBLISHED 100 TIMES PER SECOND */
+#define SOUND_CPU_HZ     1000000    /* CPU CLOCK WITHOUT --clock */
+
+
+void SoundInit(FemtoEmu_t *emu, const char *path, uint64_t cpu_hz, bool verbose);
+void SoundStop(FemtoEmu_t *emu);
+void SoundReport(void);
+void SoundQuit(void);
+
+#endif
@@ -0,0 +1,206 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include "stream.h"
+#include "io.h"
+#include "../cpu/int.h"
+
+
+typedef struct IOStream
+{
+    /* PRODUCER & CONSUMER INDEXES ARE FREE RUNNING, ON THEIR OWN CACHE LINE */
+    uint32_t    head __attribute__((aligned(64)));   /* WRITTEN BY THE PREFETCH THREAD */
+    bool        eos;                                 /* NO MORE DATA AFTER head */
+    uint32_t    tail __attribute__((aligned(64)));   /* WRITTEN BY THE CPU THREAD */
+    uint8_t     buf[IOSTREAM_SIZE] __attribute__((aligned(64)));
+
+    FemtoEmu_t *emu;
+    int         fd;
+    bool        irq;
+    pthread_t   thread;
+    uint64_t    reads;     /* HOST read() DONE */
+    uint64_t    waits;     /* IN RETRIED, NO DATA YET */
+} IOStream_t;
+
+
+static IOStream_t *Stream[256] = {NULL};
+
+
+/*** IO CALLBACKS OF THE STREAMED PORTS ***/
+static uint8_t IOStreamIn(FemtoEmu_t *emu, void *ctx, uint8_t io_port)
+{
+    IOStream_t *stream = ctx;
+    uint32_t    tail   = stream->tail;
+    bool        eos    = __atomic_load_n(&stream->eos, __ATOMIC_ACQUIRE);   /* BEFORE head, SO head IS FINAL */
+    uint8_t     data   = 0;
+
+    (void)emu; (void)io_port;
+
+    if (__atomic_load_n(&stream->head, __ATOMIC_ACQUIRE) == tail)
+    {
+        if (eos) return 0x00;
+        stream->waits++;
+        IOWait();
+        return 0xFF;
+    }
+
+    data = stream->buf[tail & (IOSTREAM_SIZE - 1)];
+    __atomic_store_n(&stream->tail, tail + 1, __ATOMIC_RELEASE);
+    return data;
+}
+
+static uint8_t IOStreamStatus(FemtoEmu_t *emu, void *ctx, uint8_t io_port)
+{
+    IOStream_t *stream = ctx;
+    bool        eos    = __atomic_load_n(&stream->eos, __ATOMIC_ACQUIRE);
+
+    (void)emu; (void)io_port;
+
+    if (__atomic_load_n(&stream->head, __ATOMIC_ACQUIRE) != stream->tail) return IOSTREAM_AVAIL;
+    return eos ? IOSTREAM_EOS : 0x00;
+}
+/*** END OF IO CALLBACKS ***/
+
+
+/*** HELPING FUNCTIONS ***/
+static void * IOStreamThread(void *arg)
+{
+    const struct timespec full   = { 0, 100000 };   /* 100us */
+    IOStream_t           *stream = arg;
+    uint32_t              head   = 0;
+
+    while (true)
+    {
+        uint32_t room  = IOSTREAM_SIZE - (head - __atomic_load_n(&stream->tail, __ATOMIC_ACQUIRE));
+        uint32_t start = head & (IOSTREAM_SIZE - 1);
+        uint32_t block = IOSTREAM_SIZE - start;
+        ssize_t  n     = 0;
+        bool     empty = false;
+
+        /* RING FULL, THE GUEST IS BEHIND */
+        if (room == 0)
+        {
+            nanosleep(&full, NULL);
+            continue;
+        }
+
+        if (block > room)           block = room;
+        if (block > IOSTREAM_BLOCK) block = IOSTREAM_BLOCK;
+
+        n = read(stream->fd, stream->buf + start, block);
+        stream->reads++;
+        if (n <= 0) break;
+
+        /* DATA IN AN EMPTY RING: THE GUEST MAY BE WAITING FOR IT */
+        empty = (head == __atomic_load_n(&stream->tail, __ATOMIC_ACQUIRE));
+        head += (uint32_t)n;
+        __atomic_store_n(&stream->head, head, __ATOMIC_RELEASE);
+        if (stream->irq && empty) IREQ_LINE(stream->emu, IOSTREAM_IRQ_LINE)
+    }
+
+    /* END OF FILE (OR READ ERROR) */
+    __atomic_store_n(&stream->eos, true, __ATOMIC_RELEASE);
+    if (stream->irq) IREQ_LINE(stream->emu, IOSTREAM_IRQ_LINE)
+    return NULL;
+}
+/*** END OF HELPING FUNCTIONS ***/
+
+
+/* MUST BE CALLED AFTER IOInit() (EmuInit) */
+void IOStreamOpen(FemtoEmu_t *emu, uint8_t io_port, const char *path, bool irq, bool verbose)
+{
+    IOStream_t *stream = NULL;
+
+    if (Stream[io_port] != NULL)
+    {
+        printf("ERROR (IOStreamOpen): PORT 0x%02X IS ALREADY STREAMED !!!\n", io_port);
+        exit(-1);
+    }
+
+    stream = aligned_alloc(64, sizeof(IOStream_t));
+    if (stream == NULL)
+    {
+        printf("ERROR (IOStreamOpen): CAN'T ALLOCATE STREAM FOR PORT 0x%02X !!!\n", io_port);
+        exit(-1);
+    }
+    memset(stream, 0, sizeof(IOStream_t));
+    stream->emu = emu;
+    stream->irq = irq;
+
+    stream->fd = (strcmp(path, "-") == 0) ? STDIN_FILENO : open(path, O_RDONLY);
+    if (stream->fd < 0)
+    {
+        printf("ERROR (IOStreamOpen): CAN'T OPEN FILE \"%s\" !!!\n", path);
+        exit(-1);
+    }
+
+    Stream[io_port] = stream;
+    IORegisterIn(io_port, IOStreamIn, stream);
+    IORegisterIn((uint8_t)(io_port + 1), IOStreamStatus, stream);
+    IOPollable((uint8_t)(io_port + 1));
+
+    if (pthread_create(&stream->thread, NULL, IOStreamThread, stream) != 0)
+    {
+        printf("ERROR (IOStreamOpen): CAN'T CREATE THE PREFETCH THREAD OF PORT 0x%02X !!!\n", io_port);
+        exit(-1);
+    }
+    if (verbose == true) printf("IOSTREAM: PORT 0x%02X (STATUS 0x%02X) STREAMED FROM \"%s\"%s\n", io_port, (uint8_t)(io_port + 1), path, irq ? " WITH IRQ" : "");
+}
+
+
+void IOStreamReport(void)
+{
+    for (int p = 0; p < 256; p++)
+    {
+        if (Stream[p] == NULL) continue;
+        printf("IOSTREAM: PORT 0x%02X: %u BYTES READ BY THE GUEST, %llu HOST READS, %llu IN RETRIED%s\n", p, Stream[p]->tail,
+               (unsigned long long)Stream[p]->reads, (unsigned long long)Stream[p]->waits, Stream[p]->eos ? ", END OF STREAM" : "");
+    }
+}
+
+
+void IOStreamQuit(void)
+{
+    for (int p = 0; p < 256; p++)
+    {
+        if (Stream[p] == NULL) continue;
+
+        /* THE PREFETCH THREAD MAY BE BLOCKED IN read() ON A PIPE, read() IS A CANCELLATION POINT */
+        pthread_cancel(Stream[p]->thread);
+        pthread_join(Stream[p]->thread, NULL);
+        if (Stream[p]->fd != STDIN_FILENO) close(Stream[p]->fd);
+        free(Stream[p]);
+        Stream[p] = NULL;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+/* STREAMED INPUT PORTS:
+ * - A FILE, A PIPE OR STDIN (-) IS READ AHEAD BY ITS OWN HOST THREAD, IN BLOCKS OF UP TO
+ *   IOSTREAM_BLOCK BYTES, INTO A LOCK-FREE SINGLE PRODUCER / SINGLE CONSUMER RING
+ * - IN PORT     : NEXT BYTE OF THE STREAM; NO DATA YET: THE IN IS RETRIED LATER (IOWait),
+ *                 END OF STREAM: 0x00
+ * - IN PORT + 1 : STATUS, BIT 0 = DATA AVAILABLE, BIT 1 = END OF STREAM (NO MORE DATA, EVER)
+ * - WITH irq, THE IRQ LINE IOSTREAM_IRQ_LINE OF THE MACHINE IS RAISED WHEN DATA ARRIVE IN AN EMPTY RING, AND AT THE
+ *   END OF STREAM
+ */
+
+#ifndef STREAM_H_
+#define STREAM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../femto.h"
+
+#define IOSTREAM_SIZE   (64 * 1024)   /* BYTES PER RING, POWER OF 2 */
+#define IOSTREAM_BLOCK  (16 * 1024)   /* MAXIMUM BYTES PER HOST read() */
+#define IOSTREAM_EOS    0x02
+#define IOSTREAM_AVAIL  0x01
+
+#define IOSTREAM_IRQ_LINE  2          /* LINE OF THE INTERRUPT CONTROLLER */
+
+
+void IOStreamOpen(FemtoEmu_t *emu, uint8_t io_port, const char *path, bool irq, bool verbose);
+void IOStreamReport(void);
+void IOStreamQuit(void);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,137 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+#include <stdio.h>
+#include "timer.h"
+#include "io.h"
+#include "../cpu/event.h"
+#include "../cpu/int.h"
+
+
+typedef struct FemtoTimer
+{
+    FemtoEmu_t *emu;
+    uint16_t    period;     /* PERIOD REGISTER (0 = 65536) */
+    uint8_t     ctrl;       /* CONTROL REGISTER */
+    uint8_t     ticks;      /* EXPIRATIONS NOT ACKNOWLEDGED */
+    bool        armed;
+    uint32_t    event;      /* ID OF THE PENDING EVENT */
+    uint64_t    deadline;   /* CYCLE OF THE PENDING EVENT */
+    uint64_t    fired;      /* TOTAL EXPIRATIONS */
+} FemtoTimer_t;
+
+
+/* THE IO CALLBACKS ARE GLOBAL, SO THERE IS ONLY ONE TIMER AT A TIME */
+static FemtoTimer_t Timer;
+
+
+/*** HELPING FUNCTIONS ***/
+static uint64_t TimerInterval(void)
+{
+    uint64_t period = (Timer.period == 0) ? 0x10000 : Timer.period;
+
+    return period << (Timer.ctrl >> 4);
+}
+
+static void TimerExpire(FemtoEmu_t *emu, void *arg)
+{
+    (void)arg;
+
+    Timer.fired++;
+    if (Timer.ticks < 0xFF) Timer.ticks++;
+    IREQ_LINE(emu, TIMER_IRQ_LINE)
+
+    if (Timer.ctrl & TIMER_PERIODIC)
+    {
+        Timer.deadline += TimerInterval();
+        Timer.event     = EventAdd(emu, Timer.deadline, TimerExpire, NULL);
+    }
+    else
+    {
+        Timer.armed = false;
+    }
+}
+/*** END OF HELPING FUNCTIONS ***/
+
+
+/*** IO CALLBACKS ***/
+static OUTFUNC(TimerPeriodLo, data)
+{
+    Timer.period = (Timer.period & 0xFF00) | data;
+}
+
+static OUTFUNC(TimerPeriodHi, data)
+{
+    Timer.period = (uint16_t)((Timer.period & 0x00FF) | (data << 8));
+}
+
+static OUTFUNC(TimerControl, data)
+{
+    if (Timer.armed) EventCancel(Timer.emu, Timer.event);
+
+    Timer.ctrl  = data;
+    Timer.armed = (data & TIMER_ENABLE) != 0;
+    if (Timer.armed)
+    {
+        Timer.deadline = Timer.emu->cycles + TimerInterval();
+        Timer.event    = EventAdd(Timer.emu, Timer.deadline, TimerExpire, NULL);
+    }
+}
+
+static INPFUNC(TimerTicks)
+{
+    return Timer.ticks;
+}
+
+static OUTFUNC(TimerAck, data)
+{
+    Timer.ticks = (data < Timer.ticks) ? (uint8_t)(Timer.ticks - data) : 0;
+}
+/*** END OF IO CALLBACKS ***/
+
+
+/* MUST BE CALLED AFTER IOInit() (EmuInit) */
+void TimerInit(FemtoEmu_t *emu, bool verbose)
+{
+    Timer     = (FemtoTimer_t){0};
+    Timer.emu = emu;
+
+    RegisterOutputFunc(TimerPeriodLo, TIMER_LO_PORT);
+    RegisterOutputFunc(TimerPeriodHi, TIMER_HI_PORT);
+    RegisterOutputFunc(TimerControl, TIMER_CTRL_PORT);
+    RegisterInputFunc(TimerTicks, TIMER_CTRL_PORT);
+    RegisterOutputFunc(TimerAck, TIMER_ACK_PORT);
+    IOPollable(TIMER_CTRL_PORT);
+
+    if (verbose == true) printf("TIMER: PORTS 0x%02X - 0x%02X\n", TIMER_LO_PORT, TIMER_ACK_PORT);
+}
+
+
+void TimerReport(void)
+{
+    printf("TIMER: %llu EXPIRATIONS\n", (unsigned long long)Timer.fired);
+}
\ No newline at end of file
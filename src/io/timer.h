@@ -0,0 +1,60 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+/* PROGRAMMABLE INTERVAL TIMER:
+ * - OUT TIMER_LO_PORT / TIMER_HI_PORT : PERIOD IN GUEST CYCLES (16BITS, 0 = 65536)
+ * - OUT TIMER_CTRL_PORT : BIT 0 ENABLE, BIT 1 PERIODIC (ELSE ONE-SHOT), BITS 4-7 PRESCALER
+ *   (THE PERIOD IS SHIFTED LEFT BY IT); EACH WRITE RESTART THE COUNT FROM THE CURRENT CYCLE
+ * - IN  TIMER_CTRL_PORT : EXPIRATIONS NOT ACKNOWLEDGED YET (SATURATE AT 255), THE READ HAS NO SIDE EFFECT SO A
+ *   LOOP POLLING IT CAN BE FAST-FORWARDED (idle.c)
+ * - OUT TIMER_ACK_PORT : ACKNOWLEDGE data EXPIRATIONS (THE COUNT READ), THOSE COME SINCE THE READ ARE KEPT
+ * - EACH EXPIRATION RAISE THE IRQ LINE TIMER_IRQ_LINE; A PERIODIC TIMER IS RESCHEDULED FROM ITS DEADLINE, NOT FROM
+ *   THE CYCLE IT WAS SERVED, SO IT NEVER DRIFT
+ */
+
+#ifndef TIMER_H_
+#define TIMER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../femto.h"
+
+#define TIMER_LO_PORT    0xF0
+#define TIMER_HI_PORT    0xF1
+#define TIMER_CTRL_PORT  0xF2
+#define TIMER_ACK_PORT   0xF3
+
+#define TIMER_ENABLE     0x01
+#define TIMER_PERIODIC   0x02
+
+#define TIMER_IRQ_LINE   1      /* LINE OF THE INTERRUPT CONTROLLER */
+
+
+void TimerInit(FemtoEmu_t *emu, bool verbose);
+void TimerReport(void);
+
+#endif
\ No newline at end of file
@@ -26,10 +26,28 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 #include "femto.h"
 #include "common.h"
+#include "cpu/lockstep.h"
+#include "cpu/smp.h"
+#include "sched/sched.h"
+#include "sched/net.h"
+#include "fuzz/forksrv.h"
+#include "fuzz/fuzz.h"
+#include "io/ring.h"
+#include "io/stream.h"
+#include "io/timer.h"
+#include "cpu/idle.h"
+#include "cpu/clock.h"
+#include "io/dma.h"
+#include "io/disk.h"
+#include "io/fb.h"
+#include "io/sound.h"
+#include "io/coproc.h"
+#include "io/serial.h"
 
 
 /*** CMD FUNCTIONS ***/
@@ -45,6 +63,46 @@ void CmdHelp(void)
     printf(" -f\n");
     printf("--verbose     : specify to femto to output more information\n");
     printf(" -vb\n");
+    printf("--lockstep [N]: run N machines of the same ROM in lockstep (SIMD)\n");
+    printf(" -ls\n");
+    printf("--machines [N]: run N machines of the same ROM time-sliced on one host thread\n");
+    printf(" -m\n");
+    printf("--quantum [C] : time slice of each machine, in guest cycles (default %d)\n", SCHED_QUANTUM);
+    printf(" -q\n");
+    printf("--net [FILE]  : run the network of machines described in FILE (MACHINE/LINK lines)\n");
+    printf(" -n\n");
+    printf("--threads [T] : number of host threads for the network (default 1)\n");
+    printf(" -t\n");
+    printf("--cores [N]   : run the ROM on a SMP machine of N cores sharing the RAM\n");
+    printf(" -c\n");
+    printf("--forkserver [PORTS]: run as an AFL fork server, feeding the test case to the IN PORTS (ex: 0x20,0x21)\n");
+    printf(" -fs\n");
+    printf("--fork-pc [ADDR]    : snapshot point of the fork server (default: first IN on a fuzzed port)\n");
+    printf("--limit [C]         : cycles limit of a fuzzed test case (default %d)\n", FORKSRV_LIMIT);
+    printf("--input [FILE]      : read the test case from FILE instead of stdin (seed of --fuzz)\n");
+    printf("--fuzz [PORTS]      : fuzz in-process the ROM, mutating the bytes read on the IN PORTS\n");
+    printf(" -fz\n");
+    printf("--fuzz-execs [N]    : number of executions of the fuzzer (default %d)\n", FUZZ_EXECS);
+    printf("--fuzz-out [DIR]    : directory of the corpus & crash reproducers (default %s)\n", FUZZ_OUT_DIR);
+    printf("--buffer-out [PORT:FILE]: buffer the OUT to PORT, a host thread write them to FILE (- : stdout)\n");
+    printf(" -bo\n");
+    printf("--buffer-policy [P]     : buffered port full: block (retry the OUT, default) or drop\n");
+    printf("--stream-in [PORT:FILE] : IN from PORT read FILE (- : stdin) prefetched by a host thread, PORT + 1 is its status\n");
+    printf(" -si\n");
+    printf("--stream-irq            : raise the IRQ when data arrive on a streamed port, and at its end\n");
+    printf("--timer                 : add the programmable interval timer (ports 0x%02X - 0x%02X)\n", TIMER_LO_PORT, TIMER_ACK_PORT);
+    printf("--dma                   : add the DMA controller (ports 0x%02X - 0x%02X)\n", DMA_SRC_PORT, DMA_CTRL_PORT);
+    printf("--disk [FILE]           : add the block storage device backed by the image FILE (ports 0x%02X - 0x%02X)\n", DISK_LBA_PORT, DISK_CMD_PORT);
+    printf("--disk-overlay [FILE]   : write the sectors to the overlay FILE, the image is only read\n");
+    printf("--disk-thread           : run the block storage device on its own host thread\n");
+    printf("--fb                    : add the framebuffer (%dx%d, 16 colors, ports 0x%02X - 0x%02X)\n", FB_WIDTH, FB_HEIGHT, FB_X_PORT, FB_FRAME_PORT);
+    printf("--fb-ppm [PREFIX]       : export each changed frame to PREFIXnnnnnn.ppm\n");
+    printf("--fb-shm [NAME]         : export the frames to the shared memory NAME (ex: /femto-fb)\n");
+    printf("--sound [FILE]          : add the sound chip (ports 0x%02X - 0x%02X), rendered to the WAV FILE (or a pipe)\n", SOUND_REG_PORT, SOUND_DATA_PORT);
+    printf("--coproc                : add the math coprocessor, MUL/DIV/MOD/SQRT on 16 bits (ports 0x%02X - 0x%02X)\n", COPROC_A_PORT, COPROC_RES_PORT + 3);
+    printf("--serial                : add the serial console on a host pseudo-terminal (ports 0x%02X - 0x%02X)\n", SERIAL_DATA_PORT, SERIAL_CTRL_PORT);
+    printf("--idle                  : fast-forward the polling loops of the guest to the next device event\n");
+    printf("--clock [HZ]            : run the guest in real time at HZ cycles per second (ex: 1M, 500k)\n");
 }
 
 void CmdVersion(void)
@@ -62,6 +120,36 @@ int main(int argc, char *argv[])
     char       *rom      = NULL;
     FemtoEmu_t *EmuState = NULL;
     bool        verbose  = false;
+    int         lanes    = 0;
+    int         machines = 0;
+    int         quantum  = SCHED_QUANTUM;
+    char       *topology = NULL;
+    int         threads  = 1;
+    int         cores    = 0;
+    bool        fuzz     = false;
+    bool        fuzz_in  = false;
+    uint64_t    execs    = FUZZ_EXECS;
+    char       *fuzz_out = FUZZ_OUT_DIR;
+    char       *buffered[256];
+    int         nbuffered  = 0;
+    int         policy     = IORING_BLOCK;
+    char       *streamed[256];
+    int         nstreamed  = 0;
+    bool        stream_irq = false;
+    bool        timer      = false;
+    bool        idle       = false;
+    bool        dma        = false;
+    char       *disk       = NULL;
+    char       *overlay    = NULL;
+    bool        disk_thread = false;
+    bool        fb         = false;
+    char       *fb_ppm     = NULL;
+    char       *fb_shm     = NULL;
+    char       *sound      = NULL;
+    bool        coproc     = false;
+    bool        serial     = false;
+    uint64_t    clock      = 0;
+    ForkSrvConfig_t fuzz_cfg = { .fork_pc = -1, .limit = FORKSRV_LIMIT, .input = NULL };
 
 
     /*** COMMAND-LINE ARGUMENTS ***/
@@ -92,14 +180,319 @@ int main(int argc, char *argv[])
         {
             verbose = true;
         }
+        else if (strcmp(argv[i], "--lockstep") == 0 || strcmp(argv[i], "-ls") == 0)
+        {
+            i++;
+            lanes = (i < argc) ? atoi(argv[i]) : 0;
+        }
+        else if (strcmp(argv[i], "--machines") == 0 || strcmp(argv[i], "-m") == 0)
+        {
+            i++;
+            machines = (i < argc) ? atoi(argv[i]) : 0;
+        }
+        else if (strcmp(argv[i], "--quantum") == 0 || strcmp(argv[i], "-q") == 0)
+        {
+            i++;
+            quantum = (i < argc) ? atoi(argv[i]) : 0;
+        }
+        else if (strcmp(argv[i], "--net") == 0 || strcmp(argv[i], "-n") == 0)
+        {
+            i++;
+            topology = argv[i];
+        }
+        else if (strcmp(argv[i], "--threads") == 0 || strcmp(argv[i], "-t") == 0)
+        {
+            i++;
+            threads = (i < argc) ? atoi(argv[i]) : 1;
+        }
+        else if (strcmp(argv[i], "--cores") == 0 || strcmp(argv[i], "-c") == 0)
+        {
+            i++;
+            cores = (i < argc) ? atoi(argv[i]) : 0;
+        }
+        else if (strcmp(argv[i], "--forkserver") == 0 || strcmp(argv[i], "-fs") == 0)
+        {
+            i++;
+            fuzz = true;
+            if (i >= argc || !ForkSrvParsePorts(&fuzz_cfg, argv[i]))
+            {
+                printf("ERROR (main): INVALID LIST OF FUZZED PORTS !!!\n");
+                return -1;
+            }
+        }
+        else if (strcmp(argv[i], "--fuzz") == 0 || strcmp(argv[i], "-fz") == 0)
+        {
+            i++;
+            fuzz_in = true;
+            if (i >= argc || !ForkSrvParsePorts(&fuzz_cfg, argv[i]))
+            {
+                printf("ERROR (main): INVALID LIST OF FUZZED PORTS !!!\n");
+                return -1;
+            }
+        }
+        else if (strcmp(argv[i], "--fuzz-execs") == 0)
+        {
+            i++;
+            execs = (i < argc) ? strtoull(argv[i], NULL, 0) : FUZZ_EXECS;
+        }
+        else if (strcmp(argv[i], "--fuzz-out") == 0)
+        {
+            i++;
+            fuzz_out = (i < argc) ? argv[i] : FUZZ_OUT_DIR;
+        }
+        else if (strcmp(argv[i], "--buffer-out") == 0 || strcmp(argv[i], "-bo") == 0)
+        {
+            i++;
+            if (i < argc && nbuffered < 256) buffered[nbuffered++] = argv[i];
+        }
+        else if (strcmp(argv[i], "--buffer-policy") == 0)
+        {
+            i++;
+            if (i < argc) policy = IORingParsePolicy(argv[i]);
+        }
+        else if (strcmp(argv[i], "--stream-in") == 0 || strcmp(argv[i], "-si") == 0)
+        {
+            i++;
+            if (i < argc && nstreamed < 256) streamed[nstreamed++] = argv[i];
+        }
+        else if (strcmp(argv[i], "--stream-irq") == 0)
+        {
+            stream_irq = true;
+        }
+        else if (strcmp(argv[i], "--timer") == 0)
+        {
+            timer = true;
+        }
+        else if (strcmp(argv[i], "--dma") == 0)
+        {
+            dma = true;
+        }
+        else if (strcmp(argv[i], "--disk") == 0)
+        {
+            i++;
+            disk = (i < argc) ? argv[i] : NULL;
+        }
+        else if (strcmp(argv[i], "--disk-overlay") == 0)
+        {
+            i++;
+            overlay = (i < argc) ? argv[i] : NULL;
+        }
+        else if (strcmp(argv[i], "--disk-thread") == 0)
+        {
+            disk_thread = true;
+        }
+        else if (strcmp(argv[i], "--fb") == 0)
+        {
+            fb = true;
+        }
+        else if (strcmp(argv[i], "--fb-ppm") == 0)
+        {
+            i++;
+            fb     = true;
+            fb_ppm = (i < argc) ? argv[i] : NULL;
+        }
+        else if (strcmp(argv[i], "--fb-shm") == 0)
+        {
+            i++;
+            fb     = true;
+            fb_shm = (i < argc) ? argv[i] : NULL;
+        }
+        else if (strcmp(argv[i], "--sound") == 0)
+        {
+            i++;
+            sound = (i < argc) ? argv[i] : NULL;
+        }
+        else if (strcmp(argv[i], "--coproc") == 0)
+        {
+            coproc = true;
+        }
+        else if (strcmp(argv[i], "--serial") == 0)
+        {
+            serial = true;
+        }
+        else if (strcmp(argv[i], "--idle") == 0)
+        {
+            idle = true;
+        }
+        else if (strcmp(argv[i], "--clock") == 0)
+        {
+            i++;
+            clock = (i < argc) ? ClockParseFreq(argv[i]) : 0;
+            if (clock == 0)
+            {
+                printf("ERROR (main): INVALID GUEST CLOCK FREQUENCY !!!\n");
+                return -1;
+            }
+        }
+        else if (strcmp(argv[i], "--fork-pc") == 0)
+        {
+            i++;
+            fuzz_cfg.fork_pc = (i < argc) ? (int)strtol(argv[i], NULL, 0) & 0xFFF : -1;
+        }
+        else if (strcmp(argv[i], "--limit") == 0)
+        {
+            i++;
+            fuzz_cfg.limit = (i < argc) ? strtoull(argv[i], NULL, 0) : FORKSRV_LIMIT;
+        }
+        else if (strcmp(argv[i], "--input") == 0)
+        {
+            i++;
+            fuzz_cfg.input = (i < argc) ? argv[i] : NULL;
+        }
+    }
+
+
+    /* In-process fuzzer: restore a snapshot for each input */
+    if (fuzz_in == true)
+    {
+        FemtoFuzz_t *fz = NULL;
+
+        EmuState = EmuInit(rom, verbose);
+        fz       = FuzzInit(EmuState, &fuzz_cfg, fuzz_out, verbose);
+        FuzzRun(fz, execs, verbose);
+        FuzzReport(fz);
+        FuzzQuit(fz);
+        EmuQuit(EmuState);
+        return 0;
+    }
+
+    /* Fuzzing target: fork a warm machine for each test case */
+    if (fuzz == true)
+    {
+        int ret = 0;
+
+        EmuState = EmuInit(rom, verbose);
+        ret      = ForkServer(EmuState, &fuzz_cfg, verbose);
+        EmuQuit(EmuState);
+        return ret;
+    }
+
+    /* Network of machines linked by their IO ports */
+    if (topology != NULL)
+    {
+        FemtoNet_t *net = NetInit(topology, (uint32_t)quantum, verbose);
+        NetRun(net, threads, verbose);
+        NetReport(net);
+        NetQuit(net);
+        return 0;
+    }
+
+    /* One machine, many cores */
+    if (cores > 0)
+    {
+        FemtoSmp_t *smp = SmpInit(rom, cores, verbose);
+        SmpRun(smp);
+        SmpQuit(smp);
+        return 0;
+    }
+
+    /* Many machines in lockstep */
+    if (lanes > 0)
+    {
+        FemtoLockstep_t *ls = LockstepInit(rom, lanes, verbose);
+        LockstepRun(ls, verbose);
+        LockstepQuit(ls);
+        return 0;
+    }
+
+    /* Many machines time-sliced on this thread */
+    if (machines > 0)
+    {
+        FemtoSched_t *sched = SchedInit((uint32_t)quantum);
+        FemtoEmu_t   *first = EmuInit(rom, verbose);
+
+        SchedAdd(sched, first);
+        for (int i = 1; i < machines; i++)
+        {
+            SchedAdd(sched, EmuClone(first));
+        }
+        printf("FEMTO: STARTING EMULATION OF %d MACHINES\n", machines);
+        SchedRun(sched, verbose);
+        SchedReport(sched);
+        SchedQuit(sched);
+        return 0;
     }
 
 
     /* Start the emulation */
     EmuState = EmuInit(rom, verbose);
+    for (int i = 0; i < nbuffered; i++)
+    {
+        char *sep  = strchr(buffered[i], ':');
+        long  port = strtol(buffered[i], NULL, 0);
+
+        if (sep == NULL || port < 0 || port > 0xFF)
+        {
+            printf("ERROR (main): INVALID BUFFERED PORT \"%s\" (PORT:FILE) !!!\n", buffered[i]);
+            return -1;
+        }
+        IORingOpen((uint8_t)port, sep + 1, policy, verbose);
+    }
+    if (nbuffered > 0) IORingStart();
+    if (timer == true) TimerInit(EmuState, verbose);
+    if (dma == true)   DmaInit(EmuState, verbose);
+    if (disk != NULL)  DiskOpen(EmuState, disk, overlay, disk_thread, verbose);
+    if (fb == true)    FbInit(EmuState, fb_ppm, fb_shm, verbose);
+    if (sound != NULL) SoundInit(EmuState, sound, clock, verbose);
+    if (coproc == true) CoprocInit(EmuState, verbose);
+    if (serial == true) SerialInit(EmuState, verbose);
+    if (idle == true)  IdleInit(EmuState, verbose);
+    for (int i = 0; i < nstreamed; i++)
+    {
+        char *sep  = strchr(streamed[i], ':');
+        long  port = strtol(streamed[i], NULL, 0);
+
+        if (sep == NULL || port < 0 || port > 0xFF)
+        {
+            printf("ERROR (main): INVALID STREAMED PORT \"%s\" (PORT:FILE) !!!\n", streamed[i]);
+            return -1;
+        }
+        IOStreamOpen(EmuState, (uint8_t)port, sep + 1, stream_irq, verbose);
+    }
+
+    if (clock > 0) ClockInit(EmuState, clock, verbose);
     EmuLoop(EmuState, verbose);
 
     /* End the simulation */
+    if (nbuffered > 0)
+    {
+        IORingStop();
+        IORingReport();
+        IORingQuit();
+    }
+    if (nstreamed > 0)
+    {
+        IOStreamReport();
+        IOStreamQuit();
+    }
+    if (timer == true) TimerReport();
+    if (dma == true)   DmaReport();
+    if (coproc == true) CoprocReport();
+    if (serial == true)
+    {
+        SerialStop();
+        SerialReport();
+        SerialQuit();
+    }
+    if (fb == true)
+    {
+        FbStop();
+        FbReport();
+        FbQuit();
+    }
+    if (sound != NULL)
+    {
+        SoundStop(EmuState);
+        SoundReport();
+        SoundQuit();
+    }
+    if (disk != NULL)
+    {
+        DiskReport();
+        DiskQuit();
+    }
+    IdleReport(EmuState);
+    if (clock > 0) ClockReport(EmuState);
     EmuQuit(EmuState);
 
     return 0;
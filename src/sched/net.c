@@ -0,0 +1,386 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include "net.h"
+#include "sched.h"
+#include "../cpu/cpu.h"
+#include "../io/io.h"
+
+
+typedef struct NetWorker
+{
+    FemtoNet_t *net;
+    int         first;      /* MACHINES [first, last[ ARE RUN BY THIS WORKER */
+    int         last;
+    bool        verbose;
+} NetWorker_t;
+
+/* THE IO CALLBACKS ARE GLOBAL, SO THERE IS ONLY ONE NETWORK AT A TIME */
+static FemtoNet_t *Net = NULL;
+
+
+/*** IO CALLBACKS, SHARED BY ALL MACHINES & PORTS ***/
+static OUTFUNC(NetOut, data)
+{
+    FemtoNode_t *node = &Net->node[IOMachine()->id];
+    int          l    = node->out[IOPort()];
+    FemtoLink_t *link = NULL;
+
+    if (l == NET_NO_LINK) return;
+    link = &Net->link[l];
+
+    /* QUEUE FULL (AS SEEN AT THE LAST BARRIER): BLOCK UNTIL THE NEXT QUANTUM */
+    if ((link->stage - link->seen) > link->mask)
+    {
+        link->full++;
+        IOWait();
+        return;
+    }
+    link->buf[link->stage & link->mask] = data;
+    link->stage++;
+}
+
+static INPFUNC(NetIn)
+{
+    FemtoNode_t *node = &Net->node[IOMachine()->id];
+    int          l    = node->in[IOPort()];
+    FemtoLink_t *link = NULL;
+    uint8_t      data = 0;
+
+    if (l == NET_NO_LINK) return 0xFF;
+    link = &Net->link[l];
+
+    /* NOTHING COMMITTED YET: BLOCK UNTIL THE NEXT QUANTUM */
+    if (link->head == link->tail)
+    {
+        link->empty++;
+        IOWait();
+        return 0xFF;
+    }
+    data = link->buf[link->head & link->mask];
+    link->head++;
+    link->msgs++;
+    return data;
+}
+/*** END OF IO CALLBACKS ***/
+
+
+/*** HELPING FUNCTIONS ***/
+static bool NetParseEnd(const char *str, int *machine, int *port)
+{
+    return (sscanf(str, "%i:%i", machine, port) == 2) && (*machine >= 0) && (*port >= 0) && (*port < 256);
+}
+
+/* RUN A MACHINE UNTIL THE END OF THE QUANTUM, OR UNTIL IT BLOCK ON A LINK */
+static void NetRunMachine(FemtoNode_t *node, uint64_t end, bool verbose)
+{
+    FemtoEmu_t *emu   = node->emu;
+    uint64_t    start = CYCLES;
+
+    IOBind(emu);
+    while (CYCLES < end && !HALT)
+    {
+        EmuStep(emu, verbose);
+        if (WAIT)
+        {
+            /* THE BLOCKED MACHINE IDLE UNTIL THE BARRIER, ITS CLOCK STAY ALIGNED WITH THE OTHERS */
+            WAIT = false;
+            node->exec = CYCLES - 1 - start;
+            CYCLES = end;
+            return;
+        }
+    }
+    node->exec = CYCLES - start;
+}
+
+/* SERIAL SECTION BETWEEN TWO QUANTA: PUBLISH THE STAGED BYTES & THE FREED ROOM */
+static void NetCommit(FemtoNet_t *net)
+{
+    uint64_t exec   = 0;
+    bool     halted = true;
+
+    for (int i = 0; i < net->links; i++)
+    {
+        net->link[i].tail = net->link[i].stage;
+        net->link[i].seen = net->link[i].head;
+    }
+
+    for (int i = 0; i < net->machines; i++)
+    {
+        exec  += net->node[i].exec;
+        halted = halted && net->node[i].emu->halt;
+        net->node[i].exec = 0;
+    }
+
+    net->now += net->quantum;
+    net->epochs++;
+
+    /* NOTHING RUN DURING A WHOLE QUANTUM: EVERY MACHINE IS HALTED OR WAIT FOREVER */
+    if (halted || exec == 0)
+    {
+        net->stop     = true;
+        net->deadlock = !halted;
+    }
+}
+
+static void * NetThread(void *arg)
+{
+    NetWorker_t *w   = arg;
+    FemtoNet_t  *net = w->net;
+
+    while (!net->stop)
+    {
+        uint64_t end = net->now + net->quantum;
+
+        for (int i = w->first; i < w->last; i++)
+        {
+            NetRunMachine(&net->node[i], end, w->verbose);
+        }
+
+        /* ALL MACHINES HAVE REACHED THE END OF THE QUANTUM, ONE THREAD COMMIT THE LINKS */
+        if (pthread_barrier_wait(&net->barrier) == PTHREAD_BARRIER_SERIAL_THREAD) NetCommit(net);
+        pthread_barrier_wait(&net->barrier);
+    }
+
+    return NULL;
+}
+/*** END OF HELPING FUNCTIONS ***/
+
+
+FemtoNet_t * NetInit(const char *topology, uint32_t quantum, bool verbose)
+{
+    FemtoNet_t *net      = NULL;
+    FILE       *file     = NULL;
+    char        line[256];
+    char        cmd[16];
+    char        arg1[200];
+    char        arg2[32];
+    unsigned    size     = 0;
+    int         line_num = 0;
+
+
+    file = fopen(topology, "r");
+    if (file == NULL)
+    {
+        printf("ERROR (NetInit): CAN'T OPEN FILE \"%s\" !!!\n", topology);
+        exit(-1);
+    }
+
+    net = calloc(1, sizeof(FemtoNet_t));
+    if (net == NULL)
+    {
+        printf("ERROR (NetInit): CAN'T ALLOCATE NETWORK !!!\n");
+        fclose(file);
+        exit(-1);
+    }
+    net->quantum = (quantum == 0) ? SCHED_QUANTUM : quantum;
+
+
+    /*** TOPOLOGY PARSING ***/
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        int n = 0;
+
+        line_num++;
+        if (strchr(line, '#') != NULL) *strchr(line, '#') = '\0';
+        size = NET_LINK_SIZE;
+        n    = sscanf(line, "%15s %199s %31s %u", cmd, arg1, arg2, &size);
+        if (n <= 0) continue;
+
+        if (strcasecmp(cmd, "MACHINE") == 0 && n == 2)
+        {
+            if (net->machines == NET_MAX_MACHINES)
+            {
+                printf("ERROR (NetInit): TOO MUCH MACHINES AT LINE %d (%d MAX) !!!\n", line_num, NET_MAX_MACHINES);
+                exit(-1);
+            }
+
+            FemtoNode_t *node = &net->node[net->machines];
+            node->emu     = EmuInit(arg1, verbose);
+            node->emu->id = (uint16_t)net->machines;
+            for (int p = 0; p < 256; p++)
+            {
+                node->out[p] = NET_NO_LINK;
+                node->in[p]  = NET_NO_LINK;
+            }
+            net->machines++;
+        }
+        else if (strcasecmp(cmd, "LINK") == 0 && n >= 3)
+        {
+            FemtoLink_t *link = &net->link[net->links];
+            int          src, sport, dst, dport;
+            uint32_t     pow2 = 1;
+
+            if (!NetParseEnd(arg1, &src, &sport) || !NetParseEnd(arg2, &dst, &dport) ||
+                src >= net->machines || dst >= net->machines || size == 0 || net->links == NET_MAX_LINKS)
+            {
+                printf("ERROR (NetInit): INVALID LINK AT LINE %d !!!\n", line_num);
+                exit(-1);
+            }
+            if (net->node[src].out[sport] != NET_NO_LINK || net->node[dst].in[dport] != NET_NO_LINK)
+            {
+                printf("ERROR (NetInit): PORT ALREADY LINKED AT LINE %d !!!\n", line_num);
+                exit(-1);
+            }
+
+            while (pow2 < size) pow2 <<= 1;
+            link->buf = malloc(pow2);
+            if (link->buf == NULL)
+            {
+                printf("ERROR (NetInit): CAN'T ALLOCATE LINK BUFFER !!!\n");
+                exit(-1);
+            }
+            link->src      = src;
+            link->src_port = (uint8_t)sport;
+            link->dst      = dst;
+            link->dst_port = (uint8_t)dport;
+            link->mask     = pow2 - 1;
+            net->node[src].out[sport] = (int16_t)net->links;
+            net->node[dst].in[dport]  = (int16_t)net->links;
+            net->links++;
+        }
+        else
+        {
+            printf("ERROR (NetInit): SYNTAX ERROR AT LINE %d !!!\n", line_num);
+            exit(-1);
+        }
+    }
+    fclose(file);
+
+    if (net->machines == 0)
+    {
+        printf("ERROR (NetInit): NO MACHINE IN \"%s\" !!!\n", topology);
+        exit(-1);
+    }
+
+
+    /* REGISTER THE LINKED PORTS ONCE ALL MACHINES ARE LOADED (EmuInit RESET THE IO) */
+    for (int i = 0; i < net->links; i++)
+    {
+        RegisterOutputFunc(NetOut, net->link[i].src_port);
+        RegisterInputFunc(NetIn, net->link[i].dst_port);
+    }
+
+    Net = net;
+    if (verbose == true) printf("NET: %d MACHINES, %d LINKS\n", net->machines, net->links);
+
+    return net;
+}
+
+
+void NetRun(FemtoNet_t *net, int threads, bool verbose)
+{
+    pthread_t       *tid    = NULL;
+    NetWorker_t     *worker = NULL;
+    struct timespec  t0, t1;
+
+
+    if (threads < 1)                threads = 1;
+    if (threads > net->machines)    threads = net->machines;
+
+    tid    = malloc(threads * sizeof(pthread_t));
+    worker = malloc(threads * sizeof(NetWorker_t));
+    if (tid == NULL || worker == NULL)
+    {
+        printf("ERROR (NetRun): CAN'T ALLOCATE THREADS !!!\n");
+        exit(-1);
+    }
+    pthread_barrier_init(&net->barrier, NULL, (unsigned)threads);
+    net->stop = false;
+
+    /*** EACH THREAD RUN A FIXED SLICE OF THE MACHINES, THE RESULT DOESN'T DEPEND ON IT ***/
+    printf("NET: STARTING EMULATION OF %d MACHINES ON %d THREADS\n", net->machines, threads);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int t = 0; t < threads; t++)
+    {
+        worker[t].net     = net;
+        worker[t].first   = (net->machines * t) / threads;
+        worker[t].last    = (net->machines * (t + 1)) / threads;
+        worker[t].verbose = verbose;
+        if (t > 0 && pthread_create(&tid[t], NULL, NetThread, &worker[t]) != 0)
+        {
+            printf("ERROR (NetRun): CAN'T CREATE THREAD !!!\n");
+            exit(-1);
+        }
+    }
+    NetThread(&worker[0]);
+    for (int t = 1; t < threads; t++)
+    {
+        pthread_join(tid[t], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    net->seconds = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    pthread_barrier_destroy(&net->barrier);
+    free(worker);
+    free(tid);
+}
+
+
+void NetReport(FemtoNet_t *net)
+{
+    uint64_t total = 0;
+    double   kcyc  = (double)net->now / 1000.0;
+    double   secs  = (net->seconds > 0.0) ? net->seconds : 1e-9;
+
+    if (net->deadlock) printf("NET: STOPPED, EVERY MACHINE NOT HALTED IS BLOCKED ON AN EMPTY OR FULL LINK\n");
+    printf("NET: %llu QUANTA OF %u CYCLES IN %.3f S\n", (unsigned long long)net->epochs, net->quantum, net->seconds);
+
+    for (int i = 0; i < net->links; i++)
+    {
+        FemtoLink_t *link = &net->link[i];
+
+        total += link->msgs;
+        printf("NET: LINK %d:0x%02X -> %d:0x%02X : %llu MSGS (%.0f MSG/S, %.3f MSG/KCYCLE), %llu FULL, %llu EMPTY\n",
+               link->src, link->src_port, link->dst, link->dst_port, (unsigned long long)link->msgs,
+               (double)link->msgs / secs, (kcyc > 0.0) ? (double)link->msgs / kcyc : 0.0,
+               (unsigned long long)link->full, (unsigned long long)link->empty);
+    }
+    printf("NET: %llu MSGS TOTAL (%.0f MSG/S)\n", (unsigned long long)total, (double)total / secs);
+}
+
+
+void NetQuit(FemtoNet_t *net)
+{
+    printf("NET: HALTING EMULATION\n");
+    for (int i = 0; i < net->machines; i++)
+    {
+        free(net->node[i].emu->ram);
+        free(net->node[i].emu);
+    }
+    for (int i = 0; i < net->links; i++)
+    {
+        free(net->link[i].buf);
+    }
+    if (Net == net) Net = NULL;
+    free(net);
+}
\ No newline at end of file
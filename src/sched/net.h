@@ -0,0 +1,95 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+/* TOPOLOGY FILE FORMAT (ONE DIRECTIVE PER LINE, '#' START A COMMENT):
+ * - MACHINE <ROM FILE>                              ==> MACHINES ARE NUMBERED FROM 0 IN ORDER OF APPEARANCE
+ * - LINK <SRC>:<OUT PORT> <DST>:<IN PORT> [SIZE]    ==> BOUNDED QUEUE OF SIZE BYTES (DEFAULT NET_LINK_SIZE)
+ */
+
+#ifndef NET_H_
+#define NET_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "../femto.h"
+
+#define NET_MAX_MACHINES  256
+#define NET_MAX_LINKS     1024
+#define NET_LINK_SIZE     64      /* DEFAULT QUEUE SIZE, IN BYTES */
+#define NET_NO_LINK       -1
+
+
+/* BOUNDED QUEUE BETWEEN TWO MACHINES. BYTES SENT DURING A QUANTUM ARE STAGED AND ONLY
+ * BECOME VISIBLE TO THE RECEIVER AT THE NEXT QUANTUM, THIS KEEP THE RUNS DETERMINISTIC. */
+typedef struct FemtoLink
+{
+    int       src;          /* SENDER MACHINE & OUT PORT */
+    uint8_t   src_port;
+    int       dst;          /* RECEIVER MACHINE & IN PORT */
+    uint8_t   dst_port;
+    uint8_t  *buf;
+    uint32_t  mask;         /* SIZE - 1, SIZE IS A POWER OF 2 */
+    uint32_t  head;         /* READ POSITION (RECEIVER ONLY) */
+    uint32_t  tail;         /* WRITE POSITION COMMITTED AT THE LAST BARRIER (READ-ONLY DURING A QUANTUM) */
+    uint32_t  stage;        /* WRITE POSITION OF THE CURRENT QUANTUM (SENDER ONLY) */
+    uint32_t  seen;         /* READ POSITION AS SEEN BY THE SENDER AT THE LAST BARRIER */
+    uint64_t  msgs;         /* BYTES DELIVERED */
+    uint64_t  full;         /* OUT BLOCKED ON A FULL QUEUE */
+    uint64_t  empty;        /* IN BLOCKED ON AN EMPTY QUEUE */
+} FemtoLink_t;
+
+typedef struct FemtoNode
+{
+    FemtoEmu_t *emu;
+    int16_t     out[256];   /* LINK FED BY EACH OUT PORT (NET_NO_LINK : NOT CONNECTED) */
+    int16_t     in[256];    /* LINK READ BY EACH IN PORT (NET_NO_LINK : NOT CONNECTED) */
+    uint64_t    exec;       /* CYCLES REALLY EXECUTED DURING THE LAST QUANTUM (NOT BLOCKED) */
+} FemtoNode_t;
+
+typedef struct FemtoNet
+{
+    FemtoNode_t       node[NET_MAX_MACHINES];
+    FemtoLink_t       link[NET_MAX_LINKS];
+    int               machines;
+    int               links;
+    uint32_t          quantum;  /* LENGTH OF A QUANTUM, IN GUEST CYCLES */
+    uint64_t          now;      /* GUEST TIME AT THE START OF THE CURRENT QUANTUM */
+    uint64_t          epochs;
+    bool              stop;
+    bool              deadlock;
+    pthread_barrier_t barrier;
+    double            seconds;  /* WALL-CLOCK TIME OF THE LAST NetRun() */
+} FemtoNet_t;
+
+
+FemtoNet_t * NetInit(const char *topology, uint32_t quantum, bool verbose);
+void         NetRun(FemtoNet_t *net, int threads, bool verbose);
+void         NetReport(FemtoNet_t *net);
+void         NetQuit(FemtoNet_t *net);
+
+#endif
\ No newline at end of file
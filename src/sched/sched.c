@@ -0,0 +1,225 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "sched.h"
+#include "../cpu/cpu.h"
+#include "../cpu/int.h"
+#include "../io/io.h"
+
+
+/*** HELPING FUNCTIONS ***/
+static void SchedPush(FemtoSched_t *s, int id)
+{
+    s->task[id].state = TASK_READY;
+    s->task[id].next  = -1;
+
+    if (s->tail < 0) s->head = id;
+    else             s->task[s->tail].next = id;
+    s->tail = id;
+}
+
+static int SchedPop(FemtoSched_t *s)
+{
+    int id = s->head;
+
+    if (id >= 0)
+    {
+        s->head = s->task[id].next;
+        if (s->head < 0) s->tail = -1;
+    }
+    return id;
+}
+
+static void SchedPark(FemtoSched_t *s, int id, task_state_t state)
+{
+    s->task[id].state  = state;
+    s->task[id].credit = 0;     /* A PARKED MACHINE DOESN'T BANK CREDIT */
+    s->task[id].parks++;
+}
+/*** END OF HELPING FUNCTIONS ***/
+
+
+FemtoSched_t * SchedInit(uint32_t quantum)
+{
+    FemtoSched_t *s = NULL;
+
+
+    s = calloc(1, sizeof(FemtoSched_t));
+    if (s == NULL)
+    {
+        printf("ERROR (SchedInit): CAN'T ALLOCATE SCHEDULER !!!\n");
+        exit(-1);
+    }
+    s->head    = -1;
+    s->tail    = -1;
+    s->quantum = (quantum == 0) ? SCHED_QUANTUM : quantum;
+
+    return s;
+}
+
+
+/* THE SCHEDULER TAKE THE OWNERSHIP OF THE MACHINE, RETURN ITS TASK ID */
+int SchedAdd(FemtoSched_t *s, FemtoEmu_t *emu)
+{
+    int id = s->count;
+
+    if (id >= SCHED_MAX)
+    {
+        printf("ERROR (SchedAdd): TOO MUCH MACHINES (%d MAX) !!!\n", SCHED_MAX);
+        exit(-1);
+    }
+
+    /* GROW THE TASK ARRAY BY DOUBLING */
+    if (s->count == s->size)
+    {
+        int          size = (s->size == 0) ? 64 : s->size * 2;
+        FemtoTask_t *task = realloc(s->task, size * sizeof(FemtoTask_t));
+
+        if (task == NULL)
+        {
+            printf("ERROR (SchedAdd): CAN'T ALLOCATE TASKS !!!\n");
+            exit(-1);
+        }
+        s->task = task;
+        s->size = size;
+    }
+
+    s->task[id].emu    = emu;
+    s->task[id].credit = 0;
+    s->task[id].slices = 0;
+    s->task[id].parks  = 0;
+    emu->id = (uint16_t)id;
+    s->count++;
+    SchedPush(s, id);
+
+    return id;
+}
+
+
+/* AN EVENT ARRIVE FOR A MACHINE BLOCKED ON AN IO PORT */
+void SchedWake(FemtoSched_t *s, int id)
+{
+    if (s->task[id].state == TASK_PARK_IO) SchedPush(s, id);
+}
+
+
+/* RAISE THE IRQ OF A MACHINE, WAKE IT UP IF IT IS HALTED OR BLOCKED */
+void SchedIrq(FemtoSched_t *s, int id)
+{
+    FemtoEmu_t *emu = s->task[id].emu;
+
+    IREQ(emu)
+    if (s->task[id].state == TASK_PARK_HLT)
+    {
+        HALT = false;
+        SchedPush(s, id);
+    }
+    else if (s->task[id].state == TASK_PARK_IO)
+    {
+        SchedPush(s, id);
+    }
+}
+
+
+/* RUN UNTIL EVERY MACHINE IS PARKED OR DONE */
+void SchedRun(FemtoSched_t *s, bool verbose)
+{
+    int id = 0;
+
+    while ((id = SchedPop(s)) >= 0)
+    {
+        FemtoTask_t *task  = &s->task[id];
+        FemtoEmu_t  *emu   = task->emu;
+        uint64_t     start = CYCLES;
+        uint64_t     end   = 0;
+
+        /* CONTEXT SWITCH: THE MACHINE STRUCT IS THE CONTEXT, ONLY THE IO BINDING CHANGE */
+        IOBind(emu);
+        s->switches++;
+        task->slices++;
+        task->credit += s->quantum;
+        end = start + (uint64_t)((task->credit > 0) ? task->credit : 0);
+
+        while (CYCLES < end && !HALT && !WAIT)
+        {
+            EmuStep(emu, verbose);
+        }
+        task->credit -= (int64_t)(CYCLES - start);
+
+        if (WAIT)
+        {
+            WAIT = false;
+            SchedPark(s, id, TASK_PARK_IO);
+            if (verbose == true) printf("SCHED: MACHINE %d PARKED ON IO\n", id);
+        }
+        else if (HALT)
+        {
+            SchedPark(s, id, CHK_IRQ_ENABLE(emu) ? TASK_PARK_HLT : TASK_DONE);
+            if (verbose == true) printf("SCHED: MACHINE %d HALTED\n", id);
+        }
+        else
+        {
+            SchedPush(s, id);
+        }
+    }
+}
+
+
+void SchedReport(FemtoSched_t *s)
+{
+    uint64_t total = 0;
+    uint64_t min   = UINT64_MAX;
+    uint64_t max   = 0;
+
+    for (int i = 0; i < s->count; i++)
+    {
+        uint64_t c = s->task[i].emu->cycles;
+
+        total += c;
+        if (c < min) min = c;
+        if (c > max) max = c;
+    }
+    if (s->count == 0) min = 0;
+
+    printf("SCHED: %d MACHINES, %llu CONTEXT SWITCHES, %llu CYCLES (MIN %llu / MAX %llu PER MACHINE)\n", s->count,
+           (unsigned long long)s->switches, (unsigned long long)total, (unsigned long long)min, (unsigned long long)max);
+}
+
+
+void SchedQuit(FemtoSched_t *s)
+{
+    printf("SCHED: HALTING EMULATION\n");
+    for (int i = 0; i < s->count; i++)
+    {
+        free(s->task[i].emu->ram);
+        free(s->task[i].emu);
+    }
+    free(s->task);
+    free(s);
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+/*
+ * Femto, a fictive computer emulator
+ * Copyright (C) 2021 Semperfis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Computer architecture:
+ * - 4KBs RAM
+ * - RISC CPU: 4 GP REGISTERS; INTEGER ONLY; REDUCE ADDRESSING MODES & MEMORY
+ * - STRUCTURE OF FLAGS REGISTER: XXXX INCZ (I : INTERRUPT; N : Negative; C : Carry; Z : Zero)
+ * - INSTRUCTION FORMAT: (I: INST; M : ADDRESSING MODES; R : REGISTERS; D : DATA; A : ADDRESS)
+ * - MIII IIII   RRRR xxxx   DDDD DDDD
+ * - MIII IIII   RRRR AAAA   AAAA AAAA
+ */
+
+#ifndef SCHED_H_
+#define SCHED_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../femto.h"
+
+#define SCHED_QUANTUM  1000    /* DEFAULT TIME SLICE, IN GUEST CYCLES */
+#define SCHED_MAX      0xFFFF  /* MAXIMUM NUMBER OF MACHINES (MACHINE INDEX IS 16BITS) */
+
+
+typedef enum task_state
+{
+    TASK_READY,         /* IN THE RUN QUEUE */
+    TASK_PARK_IO,       /* BLOCKED ON AN IO PORT, WAIT FOR SchedWake() */
+    TASK_PARK_HLT,      /* HALTED WITH IRQ ENABLE, WAIT FOR SchedIrq() */
+    TASK_DONE           /* HALTED WITH IRQ DISABLE, NOTHING CAN RESUME IT */
+} task_state_t;
+
+typedef struct FemtoTask
+{
+    FemtoEmu_t   *emu;      /* THE MACHINE, ITS STRUCT IS THE WHOLE CONTEXT */
+    task_state_t  state;
+    int64_t       credit;   /* DEFICIT ROUND-ROBIN CREDIT, IN GUEST CYCLES */
+    uint64_t      slices;   /* NUMBER OF TIME SLICES RECEIVED */
+    uint64_t      parks;    /* NUMBER OF TIMES THE MACHINE WAS PARKED */
+    int           next;     /* NEXT TASK IN THE RUN QUEUE (-1 : END) */
+} FemtoTask_t;
+
+/* GREEN-THREAD SCHEDULER, RUN MANY MACHINES ON THE CALLING HOST THREAD.
+ * NOT THREAD SAFE: SchedWake() & SchedIrq() MUST BE CALLED FROM THE SAME THREAD (IO CALLBACKS INCLUDED). */
+typedef struct FemtoSched
+{
+    FemtoTask_t *task;
+    int          count;     /* NUMBER OF MACHINES */
+    int          size;      /* ALLOCATED TASKS */
+    int          head;      /* RUN QUEUE (FIFO) */
+    int          tail;
+    uint32_t     quantum;   /* TIME SLICE, IN GUEST CYCLES */
+    uint64_t     switches;  /* NUMBER OF CONTEXT SWITCHES */
+} FemtoSched_t;
+
+
+FemtoSched_t * SchedInit(uint32_t quantum);
+int            SchedAdd(FemtoSched_t *s, FemtoEmu_t *emu);
+void           SchedWake(FemtoSched_t *s, int id);
+void           SchedIrq(FemtoSched_t *s, int id);
+void           SchedRun(FemtoSched_t *s, bool verbose);
+void           SchedReport(FemtoSched_t *s);
+void           SchedQuit(FemtoSched_t *s);
+
+#endif
\ No newline at end of file
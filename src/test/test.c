@@ -35,6 +35,8 @@
 #include "../cpu/cpu.h"
 #include "../io/io.h"
 #include "../cpu/int.h"
+#include "../cpu/event.h"
+#include "../io/dma.h"
 #include "test.h"
 
 
@@ -69,6 +71,23 @@ void ResetVar(FemtoEmu_t *emu)
     emu->dreg  = 0;         /* DESTINATION REGISTER */
     emu->sreg  = 0;         /* SOURCE REGISTER */
     emu->temp  = 0;
+    emu->cycles = 0;
+    emu->wait  = false;
+    emu->stack = STACK_BASE;
+    emu->shared = false;
+    emu->cov   = NULL;
+    emu->cov_prev = 0;
+    emu->cov_lines = NULL;
+    emu->fault = FAULT_NONE;
+    emu->dirty = 0;
+    emu->next_event = UINT64_MAX;
+    emu->events = NULL;
+    emu->idle = NULL;
+    emu->ireq  = 0;
+    emu->imask = 0xFF;
+    emu->iline = 0;
+    emu->isel  = 0;
+    for (int i = 0; i < IRQ_LINES; i++) emu->ivec[i] = IRQ_VEC_RAM;
 }
 
 
@@ -113,8 +132,28 @@ void TestOpcodeLdm(FemtoEmu_t *emu)
     R[DREG] = 0;
 
     ADRM = ADRM_REG;
+    ADDR = 0;   /* NO INDEX MODE, NO OFFSET */
     OpcodeLdm(emu, false);
     ASSERT_EQ(R[DREG], 0xBA, "LDM (ADRM_REG)")
+
+    ADDR = 0x10;   /* R1 + 0x10 */
+    DATA = 0x10;
+    RAM[0xFC] = 0x5C;
+    OpcodeLdm(emu, false);
+    ASSERT_EQ(R[DREG], 0x5C, "LDM (ADRM_REG, OFFSET)")
+
+    DREG = 2;
+    R[0] = 0x09;   /* R0:R1 = 0x9EC */
+    ADDR = ((INDEX_PAIR | INDEX_INC) << 8) | 0x01;
+    DATA = 0x01;
+    RAM[0x9ED] = 0x77;
+    OpcodeLdm(emu, false);
+    ASSERT_EQ(R[DREG], 0x77, "LDM (ADRM_REG, PAIR + OFFSET)")
+    ASSERT_EQ(R[1], 0xED, "LDM (ADRM_REG, PAIR POST-INCREMENT)")
+
+    R[1] = 0xFF;   /* R0:R1 = 0x9FF */
+    OpcodeLdm(emu, false);
+    ASSERT_EQ(R[0], 0x0A, "LDM (ADRM_REG, PAIR CARRY)")
     ResetVar(emu);
 }
 
@@ -145,8 +184,20 @@ void TestOpcodeStr(FemtoEmu_t *emu)
     RAM[ADDR] = 0;
 
     ADRM = ADRM_REG;
+    ADDR = 0;   /* NO INDEX MODE, NO OFFSET */
+    OpcodeStr(emu, false);
+    ASSERT_EQ(RAM[0xEC], 0xAD, "STR (ADRM_REG)")
+
+    ADDR = INDEX_INC << 8;
+    OpcodeStr(emu, false);
+    ASSERT_EQ(R[DREG], 0xED, "STR (ADRM_REG, POST-INCREMENT)")
+
+    DREG = 3;
+    R[2] = 0x0C;   /* R2:R3 = 0xC40 */
+    R[3] = 0x40;
+    ADDR = INDEX_PAIR << 8;
     OpcodeStr(emu, false);
-    ASSERT_EQ(RAM[ADDR], 0xAD, "STR (ADRM_REG)")
+    ASSERT_EQ(RAM[0xC40], 0xAD, "STR (ADRM_REG, PAIR)")
     ResetVar(emu);
 }
 
@@ -165,6 +216,16 @@ void TestOpcodeAdd(FemtoEmu_t *emu)
     R[SREG] = 2;
     OpcodeAdd(emu, false);
     ASSERT_EQ(CFLAG, 1, "ADD (CFLAG)")
+
+    FLAGS = 0x8;
+    OpcodeAdd(emu, false);
+    ASSERT_EQ(IFLAG, 1, "ADD (IFLAG KEPT)")
+
+    R[DREG] = 20;
+    ADRM = ADRM_IMM;
+    DATA = 5;
+    OpcodeAdd(emu, false);
+    ASSERT_EQ(R[DREG], 25, "ADD (IMM)")
     ResetVar(emu);
 }
 
@@ -183,6 +244,13 @@ void TestOpcodeSub(FemtoEmu_t *emu)
     R[SREG] = 192;
     OpcodeSub(emu, false);
     ASSERT_EQ(NFLAG, 1, "SUB (NFLAG)")
+
+    R[DREG] = 10;
+    ADRM = ADRM_IMM;
+    DATA = 10;
+    OpcodeSub(emu, false);
+    ASSERT_EQ(R[DREG], 0, "SUB (IMM)")
+    ASSERT_EQ(ZFLAG, 1, "SUB (IMM, ZFLAG)")
     ResetVar(emu);
 }
 
@@ -201,6 +269,285 @@ void TestOpcodeCmp(FemtoEmu_t *emu)
     R[SREG] = 77;
     OpcodeCmp(emu, false);
     ASSERT_EQ(ZFLAG, 1, "CMP (ZFLAG)")
+
+    ADRM = ADRM_IMM;
+    DATA = 77;
+    OpcodeCmp(emu, false);
+    ASSERT_EQ(ZFLAG, 1, "CMP (IMM, ZFLAG)")
+
+    DATA = 78;
+    OpcodeCmp(emu, false);
+    ASSERT_EQ(NFLAG, 1, "CMP (IMM, NFLAG)")
+    ResetVar(emu);
+}
+
+void TestOpcodeAnd(FemtoEmu_t *emu)
+{
+    DREG = 0;
+    SREG = 1;
+    R[DREG] = 0xF3;
+    R[SREG] = 0x3C;
+    ADRM = ADRM_REG;
+
+    OpcodeAnd(emu, false);
+    ASSERT_EQ(R[DREG], 0x30, "AND (REG)")
+
+    ADRM = ADRM_IMM;
+    DATA = 0x0F;
+    OpcodeAnd(emu, false);
+    ASSERT_EQ(ZFLAG, 1, "AND (IMM, ZFLAG)")
+
+    R[DREG] = 0xFF;
+    FLAGS = 0x8;
+    OpcodeAnd(emu, false);
+    ASSERT_EQ(FLAGS, 0x8, "AND (IFLAG KEPT)")
+    ResetVar(emu);
+}
+
+void TestOpcodeOr(FemtoEmu_t *emu)
+{
+    DREG = 0;
+    SREG = 1;
+    R[DREG] = 0xA0;
+    R[SREG] = 0x05;
+    ADRM = ADRM_REG;
+
+    OpcodeOr(emu, false);
+    ASSERT_EQ(R[DREG], 0xA5, "OR (REG)")
+
+    R[DREG] = 0;
+    ADRM = ADRM_IMM;
+    DATA = 0;
+    OpcodeOr(emu, false);
+    ASSERT_EQ(ZFLAG, 1, "OR (IMM, ZFLAG)")
+    ResetVar(emu);
+}
+
+void TestOpcodeXor(FemtoEmu_t *emu)
+{
+    DREG = 2;
+    SREG = 2;
+    R[DREG] = 0x5A;
+    ADRM = ADRM_REG;
+
+    OpcodeXor(emu, false);
+    ASSERT_EQ(R[DREG], 0, "XOR (SAME REG)")
+    ASSERT_EQ(ZFLAG, 1, "XOR (ZFLAG)")
+
+    ADRM = ADRM_IMM;
+    DATA = 0xFF;
+    OpcodeXor(emu, false);
+    ASSERT_EQ(R[DREG], 0xFF, "XOR (IMM)")
+    ResetVar(emu);
+}
+
+void TestOpcodeNot(FemtoEmu_t *emu)
+{
+    DREG = 3;
+    R[DREG] = 0x0F;
+
+    OpcodeNot(emu, false);
+    ASSERT_EQ(R[DREG], 0xF0, "NOT")
+
+    R[DREG] = 0xFF;
+    OpcodeNot(emu, false);
+    ASSERT_EQ(ZFLAG, 1, "NOT (ZFLAG)")
+    ResetVar(emu);
+}
+
+void TestOpcodeShl(FemtoEmu_t *emu)
+{
+    DREG = 0;
+    R[DREG] = 0x21;
+    ADRM = ADRM_IMM;
+    DATA = 2;
+
+    OpcodeShl(emu, false);
+    ASSERT_EQ(R[DREG], 0x84, "SHL (IMM)")
+
+    SREG = 1;
+    R[SREG] = 1;
+    ADRM = ADRM_REG;
+    OpcodeShl(emu, false);
+    ASSERT_EQ(R[DREG], 0x08, "SHL (REG)")
+    ASSERT_EQ(CFLAG, 1, "SHL (CFLAG)")
+    ResetVar(emu);
+}
+
+void TestOpcodeShr(FemtoEmu_t *emu)
+{
+    DREG = 1;
+    R[DREG] = 0x84;
+    ADRM = ADRM_IMM;
+    DATA = 2;
+
+    OpcodeShr(emu, false);
+    ASSERT_EQ(R[DREG], 0x21, "SHR (IMM)")
+    ASSERT_EQ(CFLAG, 0, "SHR (NO CFLAG)")
+
+    R[DREG] = 0x84;
+    DATA = 3;
+    OpcodeShr(emu, false);
+    ASSERT_EQ(R[DREG], 0x10, "SHR (IMM, 3)")
+    ASSERT_EQ(CFLAG, 1, "SHR (CFLAG)")
+
+    DATA = 7;
+    OpcodeShr(emu, false);
+    ASSERT_EQ(ZFLAG, 1, "SHR (ZFLAG)")
+    ResetVar(emu);
+}
+
+void TestOpcodeRol(FemtoEmu_t *emu)
+{
+    DREG = 0;
+    R[DREG] = 0x81;
+    ADRM = ADRM_IMM;
+    DATA = 1;
+
+    OpcodeRol(emu, false);
+    ASSERT_EQ(R[DREG], 0x03, "ROL")
+
+    DATA = 0;
+    OpcodeRol(emu, false);
+    ASSERT_EQ(R[DREG], 0x03, "ROL (BY 0)")
+    ResetVar(emu);
+}
+
+void TestOpcodeRor(FemtoEmu_t *emu)
+{
+    DREG = 0;
+    R[DREG] = 0x81;
+    ADRM = ADRM_IMM;
+    DATA = 1;
+
+    OpcodeRor(emu, false);
+    ASSERT_EQ(R[DREG], 0xC0, "ROR")
+
+    DATA = 12;   /* COUNT MODULO 8 */
+    OpcodeRor(emu, false);
+    ASSERT_EQ(R[DREG], 0x0C, "ROR (COUNT MASKED)")
+    ResetVar(emu);
+}
+
+void TestOpcodeInc(FemtoEmu_t *emu)
+{
+    DREG = 1;
+    R[DREG] = 0x41;
+
+    OpcodeInc(emu, false);
+    ASSERT_EQ(R[DREG], 0x42, "INC")
+
+    R[DREG] = 0xFF;
+    OpcodeInc(emu, false);
+    ASSERT_EQ(R[DREG], 0, "INC (WRAP)")
+    ASSERT_EQ(CFLAG, 1, "INC (CFLAG)")
+    ResetVar(emu);
+}
+
+void TestOpcodeDec(FemtoEmu_t *emu)
+{
+    DREG = 2;
+    R[DREG] = 1;
+
+    OpcodeDec(emu, false);
+    ASSERT_EQ(ZFLAG, 1, "DEC (ZFLAG)")
+
+    OpcodeDec(emu, false);
+    ASSERT_EQ(R[DREG], 0xFF, "DEC (WRAP)")
+    ASSERT_EQ(NFLAG, 1, "DEC (NFLAG)")
+    ResetVar(emu);
+}
+
+void TestOpcodeDjnz(FemtoEmu_t *emu)
+{
+    DREG = 3;
+    R[DREG] = 2;
+    ADDR = 0x123;
+    PC = 0x456;
+    FLAGS = 0x1;
+
+    OpcodeDjnz(emu, false);
+    ASSERT_EQ(PC, 0x123, "DJNZ (TAKEN)")
+
+    PC = 0x456;
+    OpcodeDjnz(emu, false);
+    ASSERT_EQ(PC, 0x456, "DJNZ (NOT TAKEN)")
+    ASSERT_EQ(FLAGS, 0x1, "DJNZ (FLAGS UNCHANGED)")
+    ResetVar(emu);
+}
+
+void TestOpcodeBmov(FemtoEmu_t *emu)
+{
+    bool moved = true;
+
+    /* REGISTER MODE: R2:R3 = 0x200 <== R0:R1 = 0x100, 4 BYTES */
+    for (int i = 0; i < 4; i++) RAM[0x100 + i] = (uint8_t)(i + 1);
+    R[0] = 0x01;
+    R[1] = 0x00;
+    R[2] = 0x02;
+    R[3] = 0x00;
+    DREG = 2;
+    SREG = 0;
+    ADDR = 4;
+    ADRM = ADRM_REG;
+
+    OpcodeBmov(emu, false);
+    ASSERT_EQ(RAM[0x203], 4, "BMOV (ADRM_REG)")
+    ASSERT_EQ(((R[2] << 8) | R[3]), 0x204, "BMOV (ADRM_REG, DST PAIR ADVANCED)")
+    ASSERT_EQ(((R[0] << 8) | R[1]), 0x104, "BMOV (ADRM_REG, SRC PAIR ADVANCED)")
+    ASSERT_EQ(CYCLES, 4, "BMOV (ADRM_REG, CYCLES)")
+
+    /* DESCRIPTOR AT 0x400: 0x310 <== 0x300, 100 BYTES, A FORWARD OVERLAP IN 2 CHUNKS */
+    for (int i = 0; i < 100; i++) RAM[0x300 + i] = (uint8_t)i;
+    RAM[0x400] = 0x03; RAM[0x401] = 0x10;
+    RAM[0x402] = 0x03; RAM[0x403] = 0x00;
+    RAM[0x404] = 0x00; RAM[0x405] = 100;
+    ADDR = 0x400;
+    ADRM = ADRM_IMM;
+    PC   = 3;
+
+    OpcodeBmov(emu, false);
+    ASSERT_EQ(PC, 0, "BMOV (ADRM_IMM, FIRST CHUNK, RETRIED)")
+    ASSERT_EQ(RAM[0x405], 100 - BLOCK_CHUNK, "BMOV (ADRM_IMM, LENGTH LEFT)")
+
+    PC = 3;
+    OpcodeBmov(emu, false);
+    ASSERT_EQ(PC, 3, "BMOV (ADRM_IMM, DONE)")
+    for (int i = 0; i < 100; i++) moved = moved && (RAM[0x310 + i] == i);
+    ASSERT_EQ(moved, true, "BMOV (ADRM_IMM, OVERLAP)")
+    ResetVar(emu);
+}
+
+void TestOpcodeFill(FemtoEmu_t *emu)
+{
+    /* REGISTER MODE: 4 BYTES FROM R2:R3 = 0xFFE, WRAP AT 12BITS */
+    R[1] = 0x5A;
+    R[2] = 0x0F;
+    R[3] = 0xFE;
+    DREG = 2;
+    SREG = 1;
+    ADDR = 4;
+    ADRM = ADRM_REG;
+
+    OpcodeFill(emu, false);
+    ASSERT_EQ(RAM[0xFFF], 0x5A, "FILL (ADRM_REG)")
+    ASSERT_EQ(RAM[0x001], 0x5A, "FILL (ADRM_REG, WRAP)")
+    ASSERT_EQ(((R[2] << 8) | R[3]), 0x002, "FILL (ADRM_REG, PAIR ADVANCED)")
+    ASSERT_EQ(DIRTY, 0x8001, "FILL (ADRM_REG, DIRTY PAGES)")
+
+    /* DESCRIPTOR AT 0x400: 0x500, 0xA5, 16 BYTES */
+    RAM[0x400] = 0x05; RAM[0x401] = 0x00;
+    RAM[0x402] = 0x00; RAM[0x403] = 0xA5;
+    RAM[0x404] = 0x00; RAM[0x405] = 16;
+    ADDR = 0x400;
+    ADRM = ADRM_IMM;
+    PC   = 3;
+
+    OpcodeFill(emu, false);
+    ASSERT_EQ(RAM[0x50F], 0xA5, "FILL (ADRM_IMM)")
+    ASSERT_EQ(RAM[0x510], 0x00, "FILL (ADRM_IMM, LENGTH)")
+    ASSERT_EQ(RAM[0x401], 0x10, "FILL (ADRM_IMM, DESCRIPTOR UPDATED)")
+    ASSERT_EQ(PC, 3, "FILL (ADRM_IMM, DONE)")
     ResetVar(emu);
 }
 
@@ -367,6 +714,12 @@ void TestOpcodePush(FemtoEmu_t *emu)
     SP = 0;
     OpcodePush(emu, false);
     ASSERT_EQ(RAM[STACK_BASE + (--SP)], 0x74, "PUSH (REG)")
+    ASSERT_EQ(DIRTY, 1 << (STACK_BASE >> 8), "PUSH (DIRTY PAGE)")
+    ASSERT_EQ(FAULT, FAULT_NONE, "PUSH (NO FAULT)")
+
+    SP = 0xFF;
+    OpcodePush(emu, false);
+    ASSERT_EQ(FAULT, FAULT_STACK, "PUSH (STACK WRAP FAULT)")
     ResetVar(emu);
 }
 
@@ -457,6 +810,85 @@ void TestOpcodeOut(FemtoEmu_t *emu)
 
     ResetVar(emu);
 }
+
+static uint8_t TestTypedIn(FemtoEmu_t *emu, void *ctx, uint8_t io_port)
+{
+    (void)emu;
+    return (uint8_t)(*(uint8_t *)ctx + io_port);
+}
+
+static uint32_t TestBulkOut(FemtoEmu_t *emu, void *ctx, uint8_t io_port, const uint8_t *data, uint32_t len)
+{
+    uint8_t *span = ctx;
+
+    (void)emu; (void)io_port;
+    for (uint32_t i = 0; i < len; i++)
+    {
+        span[1 + span[0]++] = data[i];
+    }
+    return len;
+}
+
+static void TestWaitOut(FemtoEmu_t *emu, void *ctx, uint8_t io_port, uint8_t data)
+{
+    uint8_t *room = ctx;   /* BYTES IT CAN TAKE, THEN THE LAST ONE TAKEN */
+
+    (void)emu; (void)io_port;
+    if (room[0] == 0)
+    {
+        IOWait();
+        return;
+    }
+    room[0]--;
+    room[1] = data;
+}
+
+void TestIOBulk(FemtoEmu_t *emu)
+{
+    uint8_t base    = 0x40;
+    uint8_t span[8] = {0};   /* COUNT, THEN THE BYTES */
+    uint8_t room[2] = {0};
+
+    IORegisterIn(0x21, TestTypedIn, &base);
+    ASSERT_EQ(In(0x21), 0x61, "IN (TYPED, CONTEXT)")
+
+    IOBind(emu);
+    IORegisterBulk(0x22, TestBulkOut, span);
+    Out(0x01, 0x22);
+    ASSERT_EQ(emu->next_event, IO_BULK_CYCLES, "OUT (BULK, FLUSH DEADLINE)")
+    emu->next_event = UINT64_MAX;
+    Out(0x02, 0x22);
+    Out(0x03, 0x22);
+    ASSERT_EQ(span[0], 0, "OUT (BULK, BUFFERED)")
+
+    /* AN IN TO ANOTHER PORT HAND OVER THE BUFFERED OUT FIRST */
+    In(0x21);
+    ASSERT_EQ(span[0], 3, "OUT (BULK, FLUSHED)")
+    ASSERT_EQ(span[3], 0x03, "OUT (BULK, ORDER)")
+
+    /* THE BULK HANDLER REMOVED WHILE BYTES ARE BUFFERED: THEY GO TO THE OUT HANDLER */
+    Out(0xAF, 0x22);
+    RegisterOutputFunc(TestOutFunc, 0x22);
+    ASSERT_EQ(IOFlush(), true, "OUT (BULK, HANDLER REMOVED)")
+
+    /* ... AND THE OUT HANDLER WAITING: THE BYTES LEFT STAY BUFFERED, THEIR MACHINE WAITS */
+    room[0] = 1;
+    IORegisterBulk(0x22, TestBulkOut, span);
+    Out(0x11, 0x22);
+    Out(0x12, 0x22);
+    IORegisterOut(0x22, TestWaitOut, room);
+    IOBind(NULL);
+    ASSERT_EQ(IOFlush(), false, "OUT (BULK, HANDLER REMOVED, WAIT)")
+    ASSERT_EQ(room[1], 0x11, "OUT (BULK, HANDLER REMOVED, 1ST BYTE)")
+    ASSERT_EQ(WAIT, true, "OUT (BULK, HANDLER REMOVED, MACHINE WAITING)")
+    room[0] = 1;
+    ASSERT_EQ(IOFlush(), true, "OUT (BULK, HANDLER REMOVED, RETRY)")
+    ASSERT_EQ(room[1], 0x12, "OUT (BULK, HANDLER REMOVED, 2ND BYTE)")
+
+    IOBind(NULL);
+    IOInit(false);
+    ResetVar(emu);
+}
 /*** END OF IO OPCODE TESTING ***/
 
 void TestOpcodeSys(FemtoEmu_t *emu)
@@ -485,6 +917,114 @@ void TestOpcodeSdi(FemtoEmu_t *emu)
     ResetVar(emu);
 }
 
+void TestOpcodeCas(FemtoEmu_t *emu)
+{
+    DREG = 1;
+    R[0] = 0x00;        /* EXPECTED VALUE */
+    R[1] = 0x01;        /* NEW VALUE */
+    ADDR = 0x800;
+    RAM[ADDR] = 0x00;
+    ADRM = ADRM_IMM;
+
+    OpcodeCas(emu, false);
+    ASSERT_EQ(RAM[ADDR], 0x01, "CAS EXCHANGED")
+    ASSERT_EQ(ZFLAG, 1, "CAS EXCHANGED (ZFLAG)")
+
+    R[1] = 0x02;
+    OpcodeCas(emu, false);
+    ASSERT_EQ(RAM[ADDR], 0x01, "CAS NOT EXCHANGED")
+    ASSERT_EQ(R[0], 0x01, "CAS NOT EXCHANGED (R0 = RAM)")
+    ASSERT_EQ(ZFLAG, 0, "CAS NOT EXCHANGED (ZFLAG)")
+
+    /* REGISTER MODE: PAIR R2:R3 + OFFSET, POST-INCREMENT */
+    R[0] = 0x00;
+    R[1] = 0x05;
+    R[2] = 0x09;
+    R[3] = 0x00;
+    SREG = 2;
+    ADDR = ((INDEX_PAIR | INDEX_INC) << 8) | 0x10;
+    DATA = 0x10;
+    RAM[0x910] = 0x00;
+    ADRM = ADRM_REG;
+    OpcodeCas(emu, false);
+    ASSERT_EQ(RAM[0x910], 0x05, "CAS (PAIR + OFFSET)")
+    ASSERT_EQ(R[3], 0x01, "CAS (POST-INCREMENT)")
+    ResetVar(emu);
+}
+
+void TestIntReq(FemtoEmu_t *emu)
+{
+    RAM[IREQ_VEC]     = 0x10;
+    RAM[IREQ_VEC + 1] = 0x02;
+    emu->ivec[1]      = 0x345;
+    ENABLE_IRQ(emu)
+
+    IREQ_LINE(emu, 3)
+    IREQ_LINE(emu, 1)
+    ASSERT_EQ(CHK_IREQ(emu), true, "IRQ PENDING")
+    IntReq(emu);
+    ASSERT_EQ(PC, 0x345, "IRQ LINE VECTOR")
+    ASSERT_EQ(emu->iline, 1, "IRQ PRIORITY")
+    ASSERT_EQ(emu->ireq, (1 << 3), "IRQ ACKNOWLEDGE")
+
+    emu->imask = (uint8_t)~(1 << 3);
+    ASSERT_EQ(CHK_IREQ(emu), false, "IRQ MASKED")
+
+    emu->imask = 0xFF;
+    IntReq(emu);
+    ASSERT_EQ(PC, 0x210, "IRQ VECTOR IN RAM")
+    ASSERT_EQ(emu->iline, 3, "IRQ LOWER PRIORITY")
+    ASSERT_EQ(CHK_IREQ(emu), false, "IRQ NONE PENDING")
+
+    /* THE CONTROLLER PORTS, WITH NO MACHINE BOUND THEN WITH ONE */
+    IntInit();
+    IOBind(NULL);
+    Out(0x0F, INTC_MASK_PORT);
+    ASSERT_EQ(In(INTC_PEND_PORT), 0x00, "INTC PORTS (NO MACHINE)")
+    IOBind(emu);
+    Out(0x0F, INTC_MASK_PORT);
+    ASSERT_EQ(In(INTC_MASK_PORT), 0x0F, "INTC PORTS (MASK)")
+
+    IOBind(NULL);
+    IOInit(false);
+    ResetVar(emu);
+}
+
+void TestDma(FemtoEmu_t *emu)
+{
+    DmaInit(emu, false);
+    IOBind(emu);
+
+    /* 16 BYTES FROM 0x800 TO 0x900 */
+    RAM[0x800] = 0xAB;
+    Out(0x00, DMA_SRC_PORT);
+    Out(0x08, DMA_SRC_PORT + 1);
+    Out(0x00, DMA_DST_PORT);
+    Out(0x09, DMA_DST_PORT + 1);
+    Out(0x10, DMA_LEN_PORT);
+    Out(0x00, DMA_LEN_PORT + 1);
+    Out(0x00, DMA_CTRL_PORT);
+    ASSERT_EQ(In(DMA_CTRL_PORT), DMA_BUSY, "DMA BUSY")
+
+    /* A REGISTER WRITE WHILE BUSY IS IGNORED, ITS ERROR STAY AFTER THE COMPLETION */
+    Out(0x01, DMA_SRC_PORT);
+    CYCLES = emu->next_event;
+    EventRun(emu);
+    ASSERT_EQ(RAM[0x900], 0xAB, "DMA RAM TO RAM")
+    ASSERT_EQ(In(DMA_CTRL_PORT), (DMA_DONE | DMA_ERROR), "DMA DONE (ERROR KEPT)")
+
+    /* THE NEXT START CLEAR THE ERROR */
+    Out(0x00, DMA_CTRL_PORT);
+    CYCLES = emu->next_event;
+    EventRun(emu);
+    ASSERT_EQ(In(DMA_CTRL_PORT), DMA_DONE, "DMA DONE")
+
+    EventQuit(emu);
+    IOBind(NULL);
+    IOInit(false);
+    ResetVar(emu);
+}
+
 /*** END OF UNIT TESTING FUNCTIONS ***/
 
 
@@ -525,6 +1065,19 @@ int main(void)
     TestOpcodeAdd(test_emu);
     TestOpcodeSub(test_emu);
     TestOpcodeCmp(test_emu);
+    TestOpcodeAnd(test_emu);
+    TestOpcodeOr(test_emu);
+    TestOpcodeXor(test_emu);
+    TestOpcodeNot(test_emu);
+    TestOpcodeShl(test_emu);
+    TestOpcodeShr(test_emu);
+    TestOpcodeRol(test_emu);
+    TestOpcodeRor(test_emu);
+    TestOpcodeInc(test_emu);
+    TestOpcodeDec(test_emu);
+    TestOpcodeDjnz(test_emu);
+    TestOpcodeBmov(test_emu);
+    TestOpcodeFill(test_emu);
     TestOpcodeJmp(test_emu);
     TestOpcodeJz(test_emu);
     TestOpcodeJnz(test_emu);
@@ -540,9 +1093,13 @@ int main(void)
     TestOpcodeRet(test_emu);
     TestOpcodeIn(test_emu);
     TestOpcodeOut(test_emu);
+    TestIOBulk(test_emu);
     TestOpcodeSys(test_emu);
     TestOpcodeSei(test_emu);
     TestOpcodeSdi(test_emu);
+    TestOpcodeCas(test_emu);
+    TestIntReq(test_emu);
+    TestDma(test_emu);
 
     return 0;
 }
\ No newline at end of file
@@ -53,6 +53,19 @@ void    OpcodeStr(FemtoEmu_t *emu, bool verbose);
 void    OpcodeAdd(FemtoEmu_t *emu, bool verbose);
 void    OpcodeSub(FemtoEmu_t *emu, bool verbose);
 void    OpcodeCmp(FemtoEmu_t *emu, bool verbose);
+void    OpcodeAnd(FemtoEmu_t *emu, bool verbose);
+void    OpcodeOr(FemtoEmu_t *emu, bool verbose);
+void    OpcodeXor(FemtoEmu_t *emu, bool verbose);
+void    OpcodeNot(FemtoEmu_t *emu, bool verbose);
+void    OpcodeShl(FemtoEmu_t *emu, bool verbose);
+void    OpcodeShr(FemtoEmu_t *emu, bool verbose);
+void    OpcodeRol(FemtoEmu_t *emu, bool verbose);
+void    OpcodeRor(FemtoEmu_t *emu, bool verbose);
+void    OpcodeInc(FemtoEmu_t *emu, bool verbose);
+void    OpcodeDec(FemtoEmu_t *emu, bool verbose);
+void    OpcodeDjnz(FemtoEmu_t *emu, bool verbose);
+void    OpcodeBmov(FemtoEmu_t *emu, bool verbose);
+void    OpcodeFill(FemtoEmu_t *emu, bool verbose);
 void    OpcodeJz(FemtoEmu_t *emu, bool verbose);
 void    OpcodeJn(FemtoEmu_t *emu, bool verbose);
 void    OpcodeJc(FemtoEmu_t *emu, bool verbose);
@@ -69,6 +82,7 @@ void    OpcodeRet(FemtoEmu_t *emu, bool verbose);
 void    OpcodeSys(FemtoEmu_t *emu, bool verbose);
 void    OpcodeSei(FemtoEmu_t *emu, bool verbose);
 void    OpcodeSdi(FemtoEmu_t *emu, bool verbose);
+void    OpcodeCas(FemtoEmu_t *emu, bool verbose);
 void    OpcodeError(FemtoEmu_t *emu, bool verbose);
 
 #endif
\ No newline at end of file
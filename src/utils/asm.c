@@ -91,6 +91,51 @@ bool is_reg(char *token, int *range)
 }
 
 
+/* INDEXED OPERAND OF LDM, STR & CAS: [REG], [REG+OFF], [R0:R1], [R2:R3+OFF], A TRAILING + POST-INCREMENT THE BASE */
+bool is_index(char *token, int *range, uint16_t *addr, uint8_t *data)
+{
+    char    reg[3] = {0};
+    char   *p      = token + 3;
+    char   *end    = NULL;
+    int     pair   = 0;
+    long    off    = 0;
+    uint8_t mode   = 0;
+
+    if (token[0] != '[' || strlen(token) < 4) return false;
+
+    strncpy(reg, token + 1, 2);
+    if (!is_reg(reg, range)) return false;
+
+    /* REGISTER PAIR, ONLY R0:R1 & R2:R3 */
+    if (*p == ':')
+    {
+        strncpy(reg, p + 1, 2);
+        if (!is_reg(reg, &pair) || (*range & 1) != 0 || pair != *range + 1) return false;
+        mode |= INDEX_PAIR;
+        p    += 3;
+    }
+
+    if (*p == '+')
+    {
+        off = strtol(p + 1, &end, 0);
+        if (end == p + 1 || off < 0 || off > 0xFF) return false;
+        p = end;
+    }
+
+    if (*p++ != ']') return false;
+    if (*p == '+')
+    {
+        mode |= INDEX_INC;
+        p++;
+    }
+    if (*p != '\0') return false;
+
+    *addr = (uint16_t)(mode << 8);
+    *data = (uint8_t)off;
+    return true;
+}
+
+
 bool check_label(const char *name)
 {
     int i = 0;
@@ -259,6 +304,12 @@ bool dst_assembler(char *token, uint8_t inst, uint8_t *dreg, uint16_t *addr, uin
                 *adrm = ADRM_REG;
                 printf("DST FIELD REGISTER R%d\n", *dreg);
             }
+            else if (inst == STR && is_index(token, &temp, addr, data))
+            {
+                *dreg = reg_trans_table[temp].value;
+                *adrm = ADRM_REG;
+                printf("DST FIELD INDEXED R%d, MODE 0x%X, OFFSET 0x%02X\n", *dreg, *addr >> 8, *data);
+            }
             else
             {
                 adrm = ADRM_IMM;
@@ -422,6 +473,12 @@ bool src_assembler(char *token, uint8_t inst, uint8_t *sreg, uint16_t *addr, uin
                 *adrm = ADRM_REG;
                 printf("SRC FIELD REGISTER R%d\n", *sreg);
             }
+            else if ((inst == LDM || inst == CAS) && is_index(token, &temp, addr, data))
+            {
+                *sreg = reg_trans_table[temp].value;
+                *adrm = ADRM_REG;
+                printf("SRC FIELD INDEXED R%d, MODE 0x%X, OFFSET 0x%02X\n", *sreg, *addr >> 8, *data);
+            }
             else
             {
                 adrm = ADRM_IMM;
@@ -484,6 +541,49 @@ bool src_assembler(char *token, uint8_t inst, uint8_t *sreg, uint16_t *addr, uin
 }
 
 
+/* REGISTER MODE OF BMOV & FILL: "BMOV R2, R0, COUNT" & "FILL R2, R1, COUNT", COUNT IS 1 - 256
+ * RETURN "TRUE" ON ILLEGAL THING */
+bool block_assembler(char *token, uint8_t inst, uint8_t dreg, uint8_t *sreg, uint8_t *data)
+{
+    int temp = 0;
+
+    /* THE DESTINATION IS A PAIR, R0:R1 OR R2:R3 */
+    if ((dreg & 1) != 0)
+    {
+        printf("(block_assembler) ERROR: DST MUST BE THE PAIR R0:R1 OR R2:R3 (R0 OR R2)\n");
+        return true;
+    }
+
+    token = get_token;
+    if (token == NULL || !is_reg(token, &temp) || (inst == BMOV && ((temp & 1) != 0 || temp == dreg)))
+    {
+        printf("(block_assembler) ERROR: ILLEGAL SRC FIELD \"%s\"\n", token ? token : "");
+        return true;
+    }
+    *sreg = reg_trans_table[temp].value;
+    printf("SRC FIELD REGISTER R%d\n", *sreg);
+
+    token = get_token;
+    if (token == NULL)
+    {
+        printf("(block_assembler) ERROR: MISSING COUNT\n");
+        return true;
+    }
+    temp = (int)strtol((const char *)token, NULL, 0);
+
+    /* 256 IS ENCODED 0 */
+    if (temp < 1 || temp > 0x100)
+    {
+        printf("(block_assembler) COUNT FIELD OUT OF RANGE (1 - 256) : 0x%X\n", temp);
+        return true;
+    }
+    *data = (uint8_t)temp;
+    printf("COUNT FIELD 0x%02X\n", *data);
+
+    return false;
+}
+
+
 bool inst_assembler(char *token, uint8_t *inst)
 {
     int i = 0;
@@ -687,6 +787,17 @@ int main(int argc, char *argv[])
                 }
 
 
+                /*** SRC & COUNT OF THE REGISTER MODE OF THE BLOCK INSTRUCTIONS ***/
+                if ((inst == BMOV || inst == FILL) && adrm == ADRM_REG && block_assembler(token, inst, dreg, &sreg, &data))
+                {
+                    printf("(main) ILLEGAL BLOCK OPERANDS AT LINE %d\n", line_num);
+                    fclose(dst_file);
+                    fclose(src_file);
+                    free(line);
+                    return -1;
+                }
+
+
                 /*** COMBINE ASSEMBLING RESULT & WRITE TO FILE ***/
                 f[0] = inst | (adrm << 7);
                 f[1] = (dreg << 6) | (sreg << 4) | ((addr & 0xF00) >> 8);
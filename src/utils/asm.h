@@ -28,35 +28,7 @@
 #ifndef ASM_H_
 #define ASM_H_
 
-typedef enum inst
-{
-    HLT  = 0x00,
-    LDR  = 0x01,
-    LDM  = 0x02,
-    STI  = 0x03,
-    STR  = 0x04,
-    ADD  = 0x05,
-    SUB  = 0x06,
-    CMP  = 0x07,
-    JZ   = 0x08, /* JUMP IF ZERO; SAME AS JE "x == y" */
-    JN   = 0x09, /* JUMP IF NEGATIVE */
-    JC   = 0x0A, /* JUMP IF CARRY; SAME AS JB (JUMP IF BELOW) "x < y" */
-    JNC  = 0x0B, /* JUMP IF NOT CARRY; SAME AS JAE (JUMP IF ABOVE OR EQUAL) " x >= y" */
-    JBE  = 0x0C, /* JUMP IF BELOW OR EQUAL (CARRY OR ZERO) "x <= y */
-    JA   = 0x0D, /* JUMP IF ABOVE (!CARRY AND !ZERO) "x > y" */
-    JMP  = 0x0E,
-    JNZ  = 0x0F, /* JUMP IF NOT ZERO; SAME AS JNE "x != y" */
-    JNN  = 0x10, /* JUMP IF NOT NEGATIVE */
-    PUSH = 0x11,
-    POP  = 0x12,
-    CALL = 0x13,
-    RET  = 0x14,
-    IN   = 0x15,
-    OUT  = 0x16,
-    SYS  = 0x17,
-    SEI  = 0x18,
-    SDI  = 0x19,
-} inst_t;
+#include "../common.h"
 
 typedef enum field_adrm
 {
@@ -90,9 +62,9 @@ const trans_t inst_trans_table[] =
     {"LDM" , LDM, REG,  BOTH, true},
     {"STI" , STI, REG,  IMM,  true},
     {"STR" , STR, BOTH, REG,  true},
-    {"ADD" , ADD, REG,  REG,  false},
-    {"SUB" , SUB, REG,  REG,  false},
-    {"CMP" , CMP, REG,  REG,  false},
+    {"ADD" , ADD, REG,  BOTH, false},
+    {"SUB" , SUB, REG,  BOTH, false},
+    {"CMP" , CMP, REG,  BOTH, false},
     {"JMP" , JMP, IMM,  NONE, true},
     {"JZ"  , JZ , IMM,  NONE, true},
     {"JNZ" , JNZ, IMM,  NONE, true},
@@ -111,6 +83,20 @@ const trans_t inst_trans_table[] =
     {"SYS" , SYS, NONE, NONE, false},
     {"SEI" , SEI, NONE, NONE, false},
     {"SDI" , SDI, NONE, NONE, false},
+    {"CAS" , CAS, REG,  BOTH, true},
+    {"AND" , AND, REG,  BOTH, false},
+    {"OR"  , OR,  REG,  BOTH, false},
+    {"XOR" , XOR, REG,  BOTH, false},
+    {"NOT" , NOT, REG,  NONE, false},
+    {"SHL" , SHL, REG,  BOTH, false},
+    {"SHR" , SHR, REG,  BOTH, false},
+    {"ROL" , ROL, REG,  BOTH, false},
+    {"ROR" , ROR, REG,  BOTH, false},
+    {"INC" , INC, REG,  NONE, false},
+    {"DEC" , DEC, REG,  NONE, false},
+    {"DJNZ", DJNZ,REG,  IMM,  true},
+    {"BMOV", BMOV,BOTH, NONE, true},
+    {"FILL", FILL,BOTH, NONE, true},
 };
 
 const trans_t reg_trans_table[] =
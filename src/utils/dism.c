@@ -84,6 +84,33 @@ void disasm_reg(uint8_t reg, char *result)
 }
 
 
+void disasm_index(uint8_t reg, uint8_t mode, uint8_t data, char *result)
+{
+    char tmp_str[16];
+
+    /* ORIGINAL REGISTER MODE, RAM[REG] */
+    if (mode == 0 && data == 0)
+    {
+        disasm_reg(reg, result);
+        return;
+    }
+
+    strncat(result, "[", DISM_BUFFER);
+    disasm_reg(reg, result);
+    if (mode & INDEX_PAIR)
+    {
+        strncat(result, ":", DISM_BUFFER);
+        disasm_reg((uint8_t)(reg + 1), result);
+    }
+    if (data != 0)
+    {
+        snprintf(tmp_str, sizeof(tmp_str), "+0x%02X", data);
+        strncat(result, (const char *)tmp_str, DISM_BUFFER);
+    }
+    strncat(result, (mode & INDEX_INC) ? "]+" : "]", DISM_BUFFER);
+}
+
+
 void disasm_dest(uint8_t finst, uint8_t dst, uint8_t data, char *result)
 {
     int  temp   = 0;
@@ -145,7 +172,8 @@ void disasm_dest(uint8_t finst, uint8_t dst, uint8_t data, char *result)
         {
             /* REGISTER ADDRESSING MODE */
             temp = (dst & 0xC0) >> 6;
-            disasm_reg((uint8_t)temp, result);
+            if (inst == STR) disasm_index((uint8_t)temp, dst & 0x0F, data, result);
+            else             disasm_reg((uint8_t)temp, result);
             return;
         }
     }
@@ -167,7 +195,7 @@ void disasm_src(uint8_t finst, uint8_t dst, uint8_t data, char *result)
     /* REGISTER SRC FIELD */
     else if(inst_trans_table[inst].src == REG)
     {
-        temp = (dst & 0xC0) >> 6;
+        temp = (dst & 0x30) >> 4;
         disasm_reg((uint8_t)temp, result);
         return;
     }
@@ -212,8 +240,9 @@ void disasm_src(uint8_t finst, uint8_t dst, uint8_t data, char *result)
         else
         {
             /* REGISTER ADDRESSING MODE */
-            temp = (dst & 0xC0) >> 6;
-            disasm_reg((uint8_t)temp, result);
+            temp = (dst & 0x30) >> 4;
+            if (inst == LDM || inst == CAS) disasm_index((uint8_t)temp, dst & 0x0F, data, result);
+            else             disasm_reg((uint8_t)temp, result);
             return;
         }
     }
@@ -224,6 +253,7 @@ void disasm(uint8_t *buffer, uint16_t pc, char *result)
 {
     uint8_t f[3] = {0};
     uint8_t inst = 0;
+    char    tmp_str[8];
 
     /* RESET RESULT STRING */
     memset((void *)result, 0, DISM_BUFFER);
@@ -245,9 +275,18 @@ void disasm(uint8_t *buffer, uint16_t pc, char *result)
         if (inst_trans_table[inst].src != NONE)
         {
             strncat(result, ", ", DISM_BUFFER);
-            disasm_src(f[0],  f[2], f[2], result);
+            disasm_src(f[0], f[1], f[2], result);
         }
     }
+
+    /* REGISTER MODE OF THE BLOCK INSTRUCTIONS, SRC REGISTER & COUNT (0 = 256) */
+    if ((inst == BMOV || inst == FILL) && ((f[0] & 0x80) >> 7) == ADRM_REG)
+    {
+        strncat(result, ", ", DISM_BUFFER);
+        disasm_reg((uint8_t)((f[1] & 0x30) >> 4), result);
+        snprintf(tmp_str, sizeof(tmp_str), ", 0x%02X", f[2] ? f[2] : 0x100);
+        strncat(result, (const char *)tmp_str, DISM_BUFFER);
+    }
 }
 
 